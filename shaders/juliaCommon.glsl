@@ -0,0 +1,702 @@
+// everything shared by the fragment and compute render paths, pulled in with #include
+// UV is the pixel centre in [0, 1], same as the interpolated UV of render.vert
+
+// shared parameter block, mirrored by juliaParamsStd140 on the C++ side
+layout(std140, binding = 0) uniform juliaParams
+{
+    mat3 rotation;
+    vec4 juliaConstant;
+    vec3 camPos;
+    float fov;
+    vec3 camLookAt;
+    float EPSILON;
+    vec3 camUp;
+    int PARAM_MAX_STEPS;
+    vec2 resolution;
+    int PARAM_AASAMPLES;
+    int PARAM_NORMAL_MODE;
+    int CONE_BLOCK;
+    int PARAM_MAX_AASAMPLES;
+    float AA_THRESHOLD;
+    int SAMPLE_PATTERN;
+    vec3 lightPos;
+    float specularity;
+    vec3 diffuseColor;
+    int EPSILON_MODE;
+    vec3 backgroundColor;
+    int MAX_MARCH_STEPS;
+    float RELAXATION;
+    // julia set is centered at origin, encapsulated by bounding sphere
+    // 2.0 until tightBoundingRadius on the C++ side has measured the current constant
+    float BOUNDING_SPHERE_RADIUS;
+    int USE_VOLUME;
+    float VOLUME_RADIUS;
+};
+
+// programs built by shaderVariants get these injected after #version as constants, so the iteration and
+// sample loops have fixed trip counts the compiler can unroll and the normal mode branch folds away
+// every other program reads them from the block
+#ifdef VARIANT_MAX_STEPS
+#define maxSteps VARIANT_MAX_STEPS
+#else
+#define maxSteps PARAM_MAX_STEPS
+#endif
+#ifdef VARIANT_AASAMPLES
+#define AASAMPLES VARIANT_AASAMPLES
+#else
+#define AASAMPLES PARAM_AASAMPLES
+#endif
+#ifdef VARIANT_MAX_AASAMPLES
+#define MAX_AASAMPLES VARIANT_MAX_AASAMPLES
+#else
+#define MAX_AASAMPLES PARAM_MAX_AASAMPLES
+#endif
+#ifdef VARIANT_NORMAL_MODE
+#define NORMAL_MODE VARIANT_NORMAL_MODE
+#else
+#define NORMAL_MODE PARAM_NORMAL_MODE
+#endif
+
+// values of NORMAL_MODE, same order as normalMethod on the C++ side
+const int NORMAL_ANALYTIC = 0;
+const int NORMAL_TETRAHEDRAL = 1;
+const int NORMAL_CENTRAL = 2;
+
+// values of EPSILON_MODE, same order as epsilonMethod on the C++ side
+const int EPSILON_ABSOLUTE = 0;
+const int EPSILON_FOOTPRINT = 1;
+
+// values of SAMPLE_PATTERN, same order as sampleSequence on the C++ side
+const int SAMPLE_HASH = 0;
+const int SAMPLE_R2 = 1;
+const int SAMPLE_SOBOL = 2;
+
+// tileable two channel blue noise from blueNoise(), scrambles the sample sequences per pixel
+layout(binding = 6) uniform sampler2D blueNoise;
+const int BLUE_NOISE_SIZE = 64;
+
+// rays of the current frame that spent MAX_MARCH_STEPS without hitting or leaving, read back by marchCounter
+layout(std430, binding = 0) buffer marchCounters
+{
+    uint exhaustedRays;
+};
+
+// index of the first sample this pass renders, advances every frame while accumulating
+uniform int sampleOffset;
+
+// safe start distance per CONE_BLOCK x CONE_BLOCK pixel block written by conePrepass.comp
+// negative when no ray of the block can hit, only read while CONE_BLOCK > 0
+layout(binding = 1) uniform sampler2D coneDepth;
+const int CONE_MAX_STEPS = 128;
+
+// last frame's hit distances carried into this view by reproject.comp, as float bits
+// 0xFFFFFFFF where nothing landed, only read while useReprojection is set
+layout(binding = 2) uniform usampler2D reprojDepth;
+uniform int useReprojection;
+// the march starts this fraction (plus the same absolute amount) short of the reprojected hit
+const float REPROJECT_MARGIN = 0.01;
+
+// distance bound baked by distanceVolume over the cube of half edge VOLUME_RADIUS, in the set's own frame
+// brickMap holds per brick of BRICK_CELLS^3 cells its atlas slot, or -1 for a brick far from the surface,
+// and the bound at the brick centre, brickAtlas one block of (BRICK_CELLS + 1)^3 samples per slot
+// only read while USE_VOLUME is set
+layout(binding = 7) uniform sampler3D brickMap;
+layout(binding = 8) uniform sampler3D brickAtlas;
+const int BRICK_CELLS = 8;
+// closer to the surface than this many cells the march goes back to the real iteration
+const float VOLUME_REFINE_CELLS = 2.0;
+
+const float ESCAPE_THRESHOLD = 1e1;
+const float DELTA = 1e-4; // used in finite difference approximation of the gradient to determine normals  
+
+vec3 camRight;
+
+// const vec4 juliaConstant = vec4(-0.04, 0.95, 0.4, -0.43);
+// const vec4 juliaConstant = vec4( 0.15, -0.85,  0.50, -0.20);
+// const vec4 juliaConstant = vec4(-0.45,  0.80,  0.15,  0.30);
+// const vec4 juliaConstant = vec4( 0.50,  0.20, -0.75,  0.25);
+// const vec4 juliaConstant = vec4(-0.60, -0.20,  0.80, -0.10);
+// const vec4 juliaConstant = vec4(0.1, -0.5, 0.6, 0.0);
+
+struct Ray
+{
+    vec3 dir;
+    vec3 origin;
+};
+
+vec4 quartMult(vec4 q1, vec4 q2)
+{
+    vec4 a;
+    a.x = q1.x * q2.x - dot(q1.yzw, q2.yzw);
+    a.yzw = q1.x * q2.yzw + q2.x * q1.yzw + cross(q1.yzw, q2.yzw);
+    return a;
+}
+
+vec4 quartSquared(vec4 q)
+{
+    vec4 a;
+    a.x = q.x * q.x - dot(q.yzw, q.yzw);
+    a.yzw = 2.0 * q.x * q.yzw;
+    return a;
+}
+
+// to move the ray onto the sphere bounding the julia set before starting raymarching
+float intersectBoundingSphere(vec3 r0, vec3 rd)
+{
+    float B = 2.0 * dot(r0, rd);
+    float C = dot(r0, r0) - BOUNDING_SPHERE_RADIUS*BOUNDING_SPHERE_RADIUS;
+
+    float disc = B*B - 4.0*C;
+    if (disc < 0.0) return -1.0;
+
+    float s = sqrt(disc);
+    float t0 = (-B - s) * 0.5;
+    float t1 = (-B + s) * 0.5;
+
+    float t = (t0 > 0.0) ? t0 : t1;
+    if (t < 0.0) return -1.0;
+
+    return t;
+}
+
+void iterateIntersect(inout vec4 q, inout vec4 qp)
+{
+    for (int i = 0; i < maxSteps; i++)
+    {
+        qp = 2.0 * quartMult(q, qp);
+        q = quartSquared(q) + juliaConstant;
+
+        if (juliaConstant == vec4(0.01))
+        {
+            q += vec4(1.0);
+        }
+
+        if (dot(q,q) > ESCAPE_THRESHOLD)
+        {
+            break;
+        }
+    }
+}
+
+// distanceBound for a point q already in the set's own frame
+float setDistanceBound(vec3 q)
+{
+    vec4 z = vec4(q, 0.0);
+    vec4 zp = vec4(1.0, 0.0, 0.0, 0.0);
+
+    iterateIntersect(z, zp);
+
+    float normZ = length(z);
+    float d = max(length(zp), 1e-6);
+    return 0.5 * normZ * log(normZ) / d;
+    // return 0.5 * normZ * log(normZ) / length(zp);
+}
+
+// lower bound on the distance from p to the julia set, no marching
+float distanceBound(vec3 p)
+{
+    return setDistanceBound(rotation * p);
+}
+
+// edge of one cell of the baked volume
+float volumeCell()
+{
+    return 2.0 * VOLUME_RADIUS / float(textureSize(brickMap, 0).x * BRICK_CELLS);
+}
+
+// distanceBound looked up in the baked volume, negative outside it
+// far bricks give the centre bound less the distance to the centre, near ones a trilinear sample
+// less one cell, which covers the interpolation error of a bound that changes by at most one per unit
+float volumeDistance(vec3 p)
+{
+    vec3 q = rotation * p;
+    float cell = volumeCell();
+    ivec3 bricks = textureSize(brickMap, 0);
+    vec3 u = (q + VOLUME_RADIUS) / cell;
+    if (any(lessThan(u, vec3(0.0))) || any(greaterThanEqual(u, vec3(bricks * BRICK_CELLS))))
+        return -1.0;
+
+    ivec3 brick = ivec3(u) / BRICK_CELLS;
+    vec2 info = texelFetch(brickMap, brick, 0).rg;
+    if (info.x < 0.0)
+    {
+        vec3 centre = (vec3(brick) + 0.5) * float(BRICK_CELLS) * cell - VOLUME_RADIUS;
+        return info.y - distance(q, centre);
+    }
+
+    // slots are laid out x first through the atlas, each block starts on a multiple of BRICK_CELLS + 1 texels
+    ivec3 atlasSize = textureSize(brickAtlas, 0);
+    ivec3 slots = atlasSize / (BRICK_CELLS + 1);
+    int slot = int(info.x);
+    ivec3 slotPos = ivec3(slot % slots.x, (slot / slots.x) % slots.y, slot / (slots.x * slots.y));
+    vec3 texel = vec3(slotPos * (BRICK_CELLS + 1)) + 0.5 + (u - vec3(brick * BRICK_CELLS));
+    return texture(brickAtlas, texel / vec3(atlasSize)).r - cell;
+}
+
+// what the march steps by, the baked volume while it is far enough from the surface, else the real iteration
+// threshold is the distance the caller decides on (the hit epsilon), it can be wider than the refine band
+// and anything the baked distance puts within reach of it is evaluated for real
+float marchDistance(vec3 p, float threshold)
+{
+    if (USE_VOLUME != 0)
+    {
+        float d = volumeDistance(p);
+        if (d > max(VOLUME_REFINE_CELLS * volumeCell(), threshold))
+            return d;
+    }
+    return distanceBound(p);
+}
+
+// angle one pixel subtends, widest at the image centre
+float pixelAngle()
+{
+    float focal = 1.0 / tan(radians(fov) * 0.5);
+    return 2.0 / (resolution.y * focal);
+}
+
+// hit threshold of a ray that has travelled t from the camera
+float hitEpsilon(float t)
+{
+    if (EPSILON_MODE == EPSILON_FOOTPRINT)
+        return EPSILON * pixelAngle() * t;
+    return EPSILON;
+}
+
+// given a point, get the distance to julia set
+// over-relaxed sphere tracing: steps are RELAXATION times the bound, which holds as long as the unbounding
+// spheres of consecutive steps overlap, and the ray falls back to plain steps the first time they do not
+// hitEps is the threshold the last step was tested against, the ray hit when the returned distance is below it
+// hitEps is negative when the ray spent MAX_MARCH_STEPS without hitting or leaving the bounding sphere
+// steps is the number of distance evaluations the march took
+float distanceEstimate(inout Ray r, out float hitEps, out int steps)
+{
+    const float bound = BOUNDING_SPHERE_RADIUS * BOUNDING_SPHERE_RADIUS;
+
+    float dist = 0.0;
+    // only the footprint threshold needs the distance travelled
+    float t = EPSILON_MODE == EPSILON_FOOTPRINT ? distance(r.origin, camPos) : 0.0;
+    float omega = max(RELAXATION, 1.0);
+    float prevDist = 0.0;
+    float stepLength = 0.0;
+
+    steps = 0;
+    for (int i = 0; i < MAX_MARCH_STEPS; i++)
+    {
+        hitEps = hitEpsilon(t);
+        dist = marchDistance(r.origin, hitEps);
+        steps++;
+
+        // the relaxed step may have skipped the surface, go back to where a plain step would have landed
+        if (omega > 1.0 && dist + prevDist < stepLength)
+        {
+            r.origin -= r.dir * (stepLength - prevDist);
+            t -= stepLength - prevDist;
+            omega = 1.0;
+            continue;
+        }
+
+        if (dist < hitEps)
+        {
+            r.origin += r.dir * dist;
+            return dist;
+        }
+
+        // a relaxed step out of the sphere only counts once the evaluation above has confirmed it
+        if (dot(r.origin, r.origin) > bound && dot(r.origin, r.dir) > 0.0)
+            return dist;
+
+        stepLength = dist * omega;
+        prevDist = dist;
+        r.origin += r.dir * stepLength;
+        t += stepLength;
+
+        if (omega == 1.0 && dot(r.origin, r.origin) > bound)
+            return dist;
+    }
+
+    hitEps = -1.0;
+    return dist;
+}
+
+float distanceEstimate(inout Ray r, out float hitEps)
+{
+    int steps;
+    return distanceEstimate(r, hitEps, steps);
+}
+
+float distanceEstimate(inout Ray r)
+{
+    float hitEps;
+    return distanceEstimate(r, hitEps);
+}
+
+float deAt(vec3 p)
+{
+    Ray r;
+    r.origin = p;
+    r.dir = vec3(1,0,0);
+    return distanceEstimate(r);
+}
+
+vec3 estimateNorm(vec3 p)
+{
+    const float e = 0.001;
+
+    float dx = deAt(p + vec3(e, 0, 0)) - deAt(p - vec3(e, 0, 0));
+    float dy = deAt(p + vec3(0, e, 0)) - deAt(p - vec3(0, e, 0));
+    float dz = deAt(p + vec3(0, 0, e)) - deAt(p - vec3(0, 0, e));
+
+    return normalize(vec3(dx, dy, dz));
+}
+
+// d(z^2) applied to the tangent v, the cross terms of z*v + v*z cancel
+vec4 jacobianStep(vec4 z, vec4 v)
+{
+    return 2.0 * vec4(z.x * v.x - dot(z.yzw, v.yzw), z.x * v.yzw + v.x * z.yzw);
+}
+
+// gradient of |z_n|^2 with respect to p, the columns of dz/dp ride along with the iteration
+// they start as the columns of rotation since z_0 = rotation * p
+vec3 analyticNorm(vec3 p)
+{
+    vec4 z = vec4(rotation * p, 0.0);
+    vec4 J0 = vec4(rotation[0], 0.0);
+    vec4 J1 = vec4(rotation[1], 0.0);
+    vec4 J2 = vec4(rotation[2], 0.0);
+
+    for (int i = 0; i < maxSteps; i++)
+    {
+        J0 = jacobianStep(z, J0);
+        J1 = jacobianStep(z, J1);
+        J2 = jacobianStep(z, J2);
+        z = quartSquared(z) + juliaConstant;
+
+        if (juliaConstant == vec4(0.01))
+        {
+            z += vec4(1.0);
+        }
+
+        if (dot(z,z) > ESCAPE_THRESHOLD)
+        {
+            break;
+        }
+    }
+
+    return normalize(vec3(dot(J0, z), dot(J1, z), dot(J2, z)));
+}
+
+// gradient from four direct distance bounds instead of six marches
+vec3 tetraNorm(vec3 p)
+{
+    const float e = 0.001;
+    const vec2 k = vec2(1.0, -1.0);
+
+    return normalize(k.xyy * distanceBound(p + k.xyy * e) +
+                     k.yyx * distanceBound(p + k.yyx * e) +
+                     k.yxy * distanceBound(p + k.yxy * e) +
+                     k.xxx * distanceBound(p + k.xxx * e));
+}
+
+vec3 surfaceNormal(vec3 p)
+{
+    if (NORMAL_MODE == NORMAL_TETRAHEDRAL)
+        return tetraNorm(p);
+    if (NORMAL_MODE == NORMAL_CENTRAL)
+        return estimateNorm(p);
+    return analyticNorm(p);
+}
+
+vec3 shadePhong(vec3 L, vec3 P, vec3 N)
+{
+    vec3 diffuse = diffuseColor;
+    const int specExp = 10;
+
+    vec3 light = normalize(L - P);
+    vec3 eye = normalize(camPos - P);
+    float nDotL = dot(N, light);
+    vec3 R = light - 2.0 * nDotL * N;
+
+    diffuse += abs(N) * 0.3; // add the normal to color for the lolz
+
+    return diffuse * max(nDotL, 0.0) + specularity * pow(max(dot(eye, R), 0.0), specExp);
+}
+
+// direction of the primary ray through uv
+vec3 cameraRayDir(vec2 uv)
+{
+    // Compute camera basis
+	vec3 camRight = normalize(cross(camLookAt, camUp));
+
+    // Compute NDC coords
+    float aR = resolution.x / resolution.y;
+    float focal = 1.0 / tan(radians(fov) * 0.5);
+
+    vec2 ndc = uv * 2.0 - 1.0;
+    vec3 target = camPos 
+                + focal * camLookAt
+                + ndc.x * aR * camRight  
+                + ndc.y * camUp;
+
+    return normalize(target - camPos);
+}
+
+// radius per unit distance of a cone around the block centre ray that holds every jittered sample ray of the block
+float coneSlope()
+{
+    return 1.1 * sqrt(2.0) * (0.5 * float(CONE_BLOCK) + 0.5) * pixelAngle();
+}
+
+// distance along dir up to which no ray inside the cone can meet the set, -1 if none of them ever does
+float coneStartDistance(vec3 origin, vec3 dir, float slope)
+{
+    // start on a sphere padded by the widest cone radius so no ray in the cone enters the real one earlier
+    float padded = BOUNDING_SPHERE_RADIUS + slope * (length(origin) + BOUNDING_SPHERE_RADIUS);
+    float B = dot(origin, dir);
+    float C = dot(origin, origin) - padded * padded;
+    float disc = B*B - C;
+    if (disc < 0.0) return -1.0;
+
+    float t = max(-B - sqrt(disc), 0.0);
+    for (int i = 0; i < CONE_MAX_STEPS; i++)
+    {
+        vec3 p = origin + dir * t;
+        float r = slope * t;
+
+        // the whole cross section left the bounding sphere on the far side
+        float outside = BOUNDING_SPHERE_RADIUS + r;
+        if (dot(p, p) > outside * outside && dot(p, dir) > 0.0)
+            return -1.0;
+
+        // cross section reached the surface, stop while t is still covered
+        float d = marchDistance(p, 2.0 * r);
+        if (d < 2.0 * r)
+            break;
+
+        // furthest t' whose cross section (radius slope * t') still fits in the sphere of radius d at t
+        t = (t + d) / (1.0 + slope);
+    }
+
+    return t;
+}
+
+// start distances every sample of one pixel shares
+struct pixelStart
+{
+    float coneT;      // conservative start from the pre-pass, the whole block misses when it is negative
+    float reprojT;    // previous frame's surface, -1 when there is none (disoccluded, march in full)
+    float reprojMinT; // nearest previous surface over the 3x3 neighbourhood, -1 when any of them has none
+};
+
+// what the march of one AA sample found, everything shading needs
+struct sampleHit
+{
+    bool hit;
+    vec3 pos;
+    vec3 normal;
+    int steps;      // march steps spent, 0 when the ray missed the bounding sphere or the cone
+};
+
+pixelStart pixelStartDistances(vec2 UV)
+{
+    pixelStart start;
+    start.coneT = 0.0;
+    if (CONE_BLOCK > 0)
+        start.coneT = texelFetch(coneDepth, ivec2(UV * resolution) / CONE_BLOCK, 0).r;
+
+    // start guess from the previous frame, not conservative so it is checked per sample
+    start.reprojT = -1.0;
+    start.reprojMinT = -1.0;
+    if (useReprojection != 0)
+    {
+        ivec2 pixel = ivec2(UV * resolution);
+        uint bits = texelFetch(reprojDepth, pixel, 0).r;
+        if (bits != 0xFFFFFFFFu)
+            start.reprojT = uintBitsToFloat(bits) * (1.0 - REPROJECT_MARGIN) - REPROJECT_MARGIN;
+
+        // positive floats order the same as their bits, a pixel without a source keeps the maximum
+        uint nearest = 0xFFFFFFFFu;
+        uint farthest = 0u;
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                uint n = texelFetch(reprojDepth, clamp(pixel + ivec2(dx, dy), ivec2(0), ivec2(resolution) - 1), 0).r;
+                nearest = min(nearest, n);
+                farthest = max(farthest, n);
+            }
+        }
+        if (start.reprojT >= 0.0 && farthest != 0xFFFFFFFFu)
+            start.reprojMinT = uintBitsToFloat(nearest) * (1.0 - REPROJECT_MARGIN) - REPROJECT_MARGIN;
+    }
+    return start;
+}
+
+// first two dimensions of the Sobol sequence as 32 bit fractions, the first is the van der Corput sequence
+uvec2 sobol2(uint i)
+{
+    uvec2 r = uvec2(0u);
+    uint v = 0x80000000u;
+    for (int bit = 0; bit < 32 && i != 0u; bit++, i >>= 1)
+    {
+        if ((i & 1u) != 0u)
+            r ^= uvec2(0x80000000u >> bit, v);
+        v ^= v >> 1;
+    }
+    return r;
+}
+
+// position of sample s inside the pixel at UV, in [0, 1)
+vec2 sampleJitter(vec2 UV, int s)
+{
+    if (SAMPLE_PATTERN == SAMPLE_HASH)
+    {
+        return vec2(
+            fract(sin(dot(UV, vec2(12.9898, 78.233)) + float(s)) * 43758.5453),
+            fract(sin(dot(UV, vec2(39.3461, 11.135)) + float(s)) * 91173.1224)
+        );
+    }
+
+    // neighbouring pixels get unrelated offsets of the same sequence, so what error is left looks like blue noise
+    vec2 noise = texelFetch(blueNoise, ivec2(UV * resolution) % BLUE_NOISE_SIZE, 0).rg;
+    if (SAMPLE_PATTERN == SAMPLE_SOBOL)
+    {
+        // XOR scrambling keeps every power of two prefix stratified
+        uvec2 bits = sobol2(uint(s)) ^ uvec2(noise * 4294967296.0);
+        return vec2(bits >> 8) / 16777216.0;
+    }
+
+    // R2, the 2D golden ratio sequence
+    const vec2 R2_ALPHA = vec2(0.7548776662466927, 0.5698402909980532);
+    return fract(noise + R2_ALPHA * float(s));
+}
+
+// primary ray direction of sample s, jittered inside the pixel
+vec3 sampleRayDir(vec2 UV, int s)
+{
+    return cameraRayDir(UV + (sampleJitter(UV, s) - 0.5) / resolution);
+}
+
+// marches sample s of the pixel at UV and takes the normal where it hit
+sampleHit traceSample(vec2 UV, int s, pixelStart start)
+{
+    sampleHit h;
+    h.hit = false;
+    h.steps = 0;
+
+    Ray ray;
+    ray.dir = sampleRayDir(UV, s);
+    ray.origin = camPos;
+
+    float t = intersectBoundingSphere(ray.origin, ray.dir);
+    if (t > 0.0 && start.coneT >= 0.0)
+    {
+        // move ray onto bounding sphere, or past the empty space the pre-pass already crossed
+        float startT = max(t, start.coneT);
+
+        // skip ahead to last frame's surface, or failing that the nearest one around this pixel, only when the
+        // unbounding spheres at both ends cover the whole gap, a surface revealed in between (disocclusion)
+        // would otherwise be jumped over
+        if (start.reprojT > startT)
+        {
+            float startBound = distanceBound(ray.origin + ray.dir * startT);
+            if (startBound + distanceBound(ray.origin + ray.dir * start.reprojT) >= start.reprojT - startT)
+                startT = start.reprojT;
+            else if (start.reprojMinT > startT && startBound + distanceBound(ray.origin + ray.dir * start.reprojMinT) >= start.reprojMinT - startT)
+                startT = start.reprojMinT;
+        }
+
+        ray.origin += ray.dir * startT;
+
+        float hitEps;
+        float dist = distanceEstimate(ray, hitEps, h.steps);
+        if (hitEps < 0.0)
+            atomicAdd(exhaustedRays, 1u);
+        if (dist <= hitEps)
+        {
+            h.hit = true;
+            h.pos = ray.origin;
+            // estimate the surface normal at this hit point
+            h.normal = surfaceNormal(ray.origin);
+        }
+    }
+
+    return h;
+}
+
+// running statistics of one pixel's samples, adaptive anti-aliasing stops on them
+struct sampleStats
+{
+    vec3 sum;
+    vec3 sumSq;
+    int count;
+    int hits;
+    float nearT;    // nearest and furthest hit distance, only meaningful once hits > 0
+    float farT;
+};
+
+// hits further apart than this fraction of the nearer one are treated as a depth edge
+const float AA_DEPTH_EDGE = 0.02;
+
+void addSample(inout sampleStats st, vec3 col, sampleHit h)
+{
+    st.sum += col;
+    st.sumSq += col * col;
+    st.count++;
+    if (h.hit)
+    {
+        float t = length(h.pos - camPos);
+        st.nearT = st.hits > 0 ? min(st.nearT, t) : t;
+        st.farT = st.hits > 0 ? max(st.farT, t) : t;
+        st.hits++;
+    }
+}
+
+// true once more samples are not expected to change the pixel
+bool pixelSettled(sampleStats st)
+{
+    // silhouette or one surface in front of another inside the pixel
+    if (st.hits > 0 && st.hits < st.count)
+        return false;
+    if (st.hits > 0 && st.farT - st.nearT > AA_DEPTH_EDGE * st.nearT)
+        return false;
+
+    // standard error of the mean below the threshold, sqrt(var / n) <= AA_THRESHOLD
+    vec3 mean = st.sum / float(st.count);
+    vec3 var = max(st.sumSq / float(st.count) - mean * mean, vec3(0.0));
+    return max(var.r, max(var.g, var.b)) <= AA_THRESHOLD * AA_THRESHOLD * float(st.count);
+}
+
+// colour of one sample, no marching
+vec3 shadeSample(sampleHit h)
+{
+    return h.hit ? shadePhong(lightPos, h.pos, h.normal) : backgroundColor;
+}
+
+// averaged colour of every AA sample of one pixel
+// with MAX_AASAMPLES above AASAMPLES, rounds of AASAMPLES more samples are added until the pixel settles or the budget is spent
+// hitDepth is the nearest hit distance over the samples, 0 when none of them hit
+vec3 renderPixel(vec2 UV, out float hitDepth)
+{
+    pixelStart start = pixelStartDistances(UV);
+
+    sampleStats st;
+    st.sum = vec3(0.0);
+    st.sumSq = vec3(0.0);
+    st.count = 0;
+    st.hits = 0;
+    st.nearT = 0.0;
+    st.farT = 0.0;
+
+    int budget = max(MAX_AASAMPLES, AASAMPLES);
+    for (int s = 0; s < budget; s++)
+    {
+        if (s >= AASAMPLES && s % AASAMPLES == 0 && pixelSettled(st))
+            break;
+
+        sampleHit h = traceSample(UV, s + sampleOffset, start);
+        addSample(st, shadeSample(h), h);
+    }
+
+    hitDepth = st.hits > 0 ? st.nearT : 0.0;
+    return st.sum / float(st.count);
+}
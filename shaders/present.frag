@@ -0,0 +1,14 @@
+#version 430
+
+// copies an offscreen frame to the window
+
+layout(binding = 0) uniform sampler2D frameTex;
+
+in vec2 UV;
+
+out vec4 color;
+
+void main()
+{
+    color = vec4(texture(frameTex, UV).rgb, 1.0);
+}
@@ -0,0 +1,39 @@
+#version 430
+
+// lighting half of the deferred path, rebuilds every sample from juliaGeometry.comp's layers
+
+#include "juliaCommon.glsl"
+
+layout(binding = 4) uniform sampler2DArray gHitDistance;
+layout(binding = 5) uniform sampler2DArray gNormal;
+
+in vec2 UV;
+
+layout(location = 0) out vec4 color;
+// nearest hit distance, the next frame reprojects it
+layout(location = 1) out float hitDepth;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    hitDepth = 0.0;
+
+    vec3 finalCol = vec3(0.0);
+    for (int s = 0; s < AASAMPLES; s++)
+    {
+        float t = texelFetch(gHitDistance, ivec3(pixel, s), 0).r;
+
+        sampleHit h;
+        h.hit = t >= 0.0;
+        h.steps = 0;
+        // same jitter as the march, so the position comes back from the distance alone
+        h.pos = camPos + sampleRayDir(UV, s) * t;
+        h.normal = normalize(texelFetch(gNormal, ivec3(pixel, s), 0).xyz);
+        if (h.hit)
+            hitDepth = hitDepth > 0.0 ? min(hitDepth, t) : t;
+
+        finalCol += shadeSample(h);
+    }
+
+    color = vec4(finalCol / float(AASAMPLES), 1.0);
+}
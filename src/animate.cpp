@@ -0,0 +1,327 @@
+// offline animation, no window, no GL context and no ImGui
+// interpolates the julia constant, camera yaw / pitch and fov between keyframes and renders every frame through
+// cpuRenderer, the frames then go through quantize, encode and write stages that each run on their own thread
+// with a bounded queue in between, so encoding and disk writes overlap the next frames' rendering
+//
+// keyframe file, one keyframe per line, # starts a comment:
+//   time  w i j k  yaw pitch  fov
+// frames are spread evenly from the first keyframe's time to the last one's, Catmull-Rom in between
+//
+// usage: animate [options] --keys keys.txt --out frames/julia_%04d.png
+//   --frames N                  frame count (120)
+//   --width N --height N        output resolution (1280x720)
+//   --aa N                      samples per pixel
+//   --iterations N              max quaternion iterations
+//   --threads N                 render threads, 0 = all cores
+//   --queue N                   frames each queue holds before the stage feeding it waits (4)
+//   --out PATTERN               path with one %d style conversion for the frame number, .qoi or anything else as png
+
+#include "cpuRenderer.h"
+#include "imageWriter.h"
+#include "boundedQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+struct keyframe
+{
+    float time;
+    glm::vec4 juliaConstant;
+    float yaw;
+    float pitch;
+    float fov;
+};
+
+// one frame on its way through the pipeline, each stage fills in its part and drops what it no longer needs
+struct animationFrame
+{
+    int index;
+    std::vector<glm::vec3> pixels;
+    std::vector<uint8_t> bytes;     // quantized RGB, then the encoded file
+};
+
+// time a stage spent working, waits on its queues not included
+struct stageTimer
+{
+    const char* name;
+    double busyMs = 0.0;
+    int frames = 0;
+};
+
+static void printUsage()
+{
+    std::cout << "usage: animate [--frames N] [--width N] [--height N] [--aa N] [--iterations N] [--threads N] [--queue N]\n"
+                 "               --keys FILE --out PATTERN.png|PATTERN.qoi\n";
+}
+
+static bool loadKeyframes(const std::string& path, std::vector<keyframe>& keys)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "failed to open " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        keyframe k;
+        std::istringstream fields(line);
+        if (!(fields >> k.time >> k.juliaConstant.x >> k.juliaConstant.y >> k.juliaConstant.z >> k.juliaConstant.w >> k.yaw >> k.pitch >> k.fov))
+        {
+            std::cerr << path << ":" << lineNumber << ": expected time w i j k yaw pitch fov" << std::endl;
+            return false;
+        }
+        keys.push_back(k);
+    }
+
+    std::stable_sort(keys.begin(), keys.end(), [](const keyframe& a, const keyframe& b) { return a.time < b.time; });
+    if (keys.empty())
+        std::cerr << path << " has no keyframes" << std::endl;
+    return !keys.empty();
+}
+
+template <typename T>
+static T catmullRom(const T& p0, const T& p1, const T& p2, const T& p3, float t)
+{
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+    return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 + (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+// keyframe at time, the end keyframes are repeated as the missing neighbours
+static keyframe interpolate(const std::vector<keyframe>& keys, float time)
+{
+    if (time <= keys.front().time)
+        return keys.front();
+    if (time >= keys.back().time)
+        return keys.back();
+
+    size_t i = 0;
+    while (keys[i + 1].time < time)
+        i++;
+    const keyframe& k0 = keys[i > 0 ? i - 1 : 0];
+    const keyframe& k1 = keys[i];
+    const keyframe& k2 = keys[i + 1];
+    const keyframe& k3 = keys[std::min(i + 2, keys.size() - 1)];
+    const float t = k2.time > k1.time ? (time - k1.time) / (k2.time - k1.time) : 0.0f;
+
+    keyframe k;
+    k.time = time;
+    k.juliaConstant = catmullRom(k0.juliaConstant, k1.juliaConstant, k2.juliaConstant, k3.juliaConstant, t);
+    k.yaw = catmullRom(k0.yaw, k1.yaw, k2.yaw, k3.yaw, t);
+    k.pitch = catmullRom(k0.pitch, k1.pitch, k2.pitch, k3.pitch, t);
+    k.fov = catmullRom(k0.fov, k1.fov, k2.fov, k3.fov, t);
+    return k;
+}
+
+// the pattern becomes a printf format, so it may hold exactly one %d (optionally %05d style) and %% otherwise
+static bool validFramePattern(const std::string& pattern)
+{
+    int conversions = 0;
+    for (size_t i = 0; i < pattern.size(); i++)
+    {
+        if (pattern[i] != '%')
+            continue;
+        if (i + 1 < pattern.size() && pattern[i + 1] == '%')
+        {
+            i++;
+            continue;
+        }
+
+        size_t j = i + 1;
+        if (j < pattern.size() && pattern[j] == '0')
+            j++;
+        while (j < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[j])))
+            j++;
+        if (j >= pattern.size() || (pattern[j] != 'd' && pattern[j] != 'i'))
+            return false;
+        conversions++;
+        i = j;
+    }
+    return conversions == 1;
+}
+
+// only called with patterns validFramePattern accepted
+static std::string framePath(const std::string& pattern, int index)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), pattern.c_str(), index);
+    return path;
+}
+
+// pops from in, runs work and pushes to out until in is closed and empty, then closes out
+template <typename Work>
+static void runStage(boundedQueue<animationFrame>& in, boundedQueue<animationFrame>* out, stageTimer& timer, Work work)
+{
+    animationFrame frame;
+    while (in.pop(frame))
+    {
+        const auto start = std::chrono::steady_clock::now();
+        work(frame);
+        timer.busyMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        timer.frames++;
+        if (out)
+            out->push(std::move(frame));
+    }
+    if (out)
+        out->close();
+}
+
+int main(int argc, char** argv)
+{
+    int width = 1280;
+    int height = 720;
+    int threads = 0;
+    int frameCount = 120;
+    int queueSize = 4;
+    std::string keysPath;
+    std::string outPattern;
+    juliaSettings settings;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+        {
+            printUsage();
+            return 0;
+        }
+        if (!value)
+        {
+            std::cerr << "missing value for " << arg << std::endl;
+            printUsage();
+            return -1;
+        }
+        i++;
+
+        if (strcmp(arg, "--width") == 0) width = atoi(value);
+        else if (strcmp(arg, "--height") == 0) height = atoi(value);
+        else if (strcmp(arg, "--frames") == 0) frameCount = atoi(value);
+        else if (strcmp(arg, "--aa") == 0) settings.aaSamples = atoi(value);
+        else if (strcmp(arg, "--iterations") == 0) settings.maxIterations = atoi(value);
+        else if (strcmp(arg, "--threads") == 0) threads = std::max(0, atoi(value));
+        else if (strcmp(arg, "--queue") == 0) queueSize = atoi(value);
+        else if (strcmp(arg, "--keys") == 0) keysPath = value;
+        else if (strcmp(arg, "--out") == 0) outPattern = value;
+        else
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            printUsage();
+            return -1;
+        }
+    }
+
+    if (keysPath.empty() || outPattern.empty() || width <= 0 || height <= 0 || frameCount <= 0 || queueSize <= 0)
+    {
+        printUsage();
+        return -1;
+    }
+
+    if (!validFramePattern(outPattern))
+    {
+        std::cerr << "--out needs exactly one integer conversion such as %04d for the frame number, write a literal % as %%" << std::endl;
+        return -1;
+    }
+
+    std::vector<keyframe> keys;
+    if (!loadKeyframes(keysPath, keys))
+        return -1;
+
+    std::string ext = outPattern.size() >= 4 ? outPattern.substr(outPattern.size() - 4) : std::string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    const bool qoi = ext == ".qoi";
+
+    cpuRenderer renderer(static_cast<unsigned>(threads));
+    camera cam(static_cast<float>(width), static_cast<float>(height));
+
+    std::cout << "rendering " << frameCount << " frames of " << width << "x" << height << " on " << renderer.threadCount()
+              << " threads (" << isaName(renderer.isa) << "), " << keys.size() << " keyframes" << std::endl;
+
+    boundedQueue<animationFrame> rendered(queueSize);
+    boundedQueue<animationFrame> quantized(queueSize);
+    boundedQueue<animationFrame> encoded(queueSize);
+    stageTimer renderTimer{ "render" }, quantizeTimer{ "quantize" }, encodeTimer{ "encode" }, writeTimer{ "write" };
+    std::atomic<int> failedWrites(0);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::thread quantizeThread([&]
+    {
+        runStage(rendered, &quantized, quantizeTimer, [&](animationFrame& frame)
+        {
+            frame.bytes = quantizeRGB8(width, height, frame.pixels);
+            frame.pixels = std::vector<glm::vec3>();
+        });
+    });
+    std::thread encodeThread([&]
+    {
+        runStage(quantized, &encoded, encodeTimer, [&](animationFrame& frame)
+        {
+            frame.bytes = qoi ? encodeQOI(width, height, frame.bytes) : encodePNG(width, height, frame.bytes);
+        });
+    });
+    std::thread writeThread([&]
+    {
+        runStage(encoded, nullptr, writeTimer, [&](animationFrame& frame)
+        {
+            if (!writeFile(framePath(outPattern, frame.index), frame.bytes))
+                failedWrites++;
+        });
+    });
+
+    for (int f = 0; f < frameCount; f++)
+    {
+        const float s = frameCount > 1 ? static_cast<float>(f) / (frameCount - 1) : 0.0f;
+        const keyframe k = interpolate(keys, keys.front().time + s * (keys.back().time - keys.front().time));
+        settings.juliaConstant = k.juliaConstant;
+        settings.fov = k.fov;
+        cam.yaw = k.yaw;
+        cam.pitch = k.pitch;
+
+        const auto renderStart = std::chrono::steady_clock::now();
+        animationFrame frame;
+        frame.index = f;
+        renderer.render(settings, cam, frame.pixels);
+        renderTimer.busyMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - renderStart).count();
+        renderTimer.frames++;
+
+        rendered.push(std::move(frame));
+    }
+    rendered.close();
+
+    quantizeThread.join();
+    encodeThread.join();
+    writeThread.join();
+
+    const double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    for (const stageTimer* timer : { &renderTimer, &quantizeTimer, &encodeTimer, &writeTimer })
+        std::cout << timer->name << ": " << (timer->frames ? timer->busyMs / timer->frames : 0.0) << " ms/frame" << std::endl;
+    std::cout << "total " << wallMs << " ms, " << wallMs / frameCount << " ms/frame" << std::endl;
+
+    if (failedWrites > 0)
+    {
+        std::cerr << failedWrites << " frames failed to write" << std::endl;
+        return -1;
+    }
+    std::cout << "wrote " << frameCount << " frames to " << outPattern << std::endl;
+    return 0;
+}
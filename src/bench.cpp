@@ -0,0 +1,265 @@
+// micro benchmarks for the CPU port of the distance estimator
+//   iterate  points/s through iterateIntersect, scalar and every lane ISA the cpu supports
+//   march    rays/s through a full distanceEstimate march from the bounding sphere
+//   normal   normals/s at hit points, once per normalMethod
+// every case is repeated and reported as median/p95 so runs can be diffed between releases
+//
+// usage: bench [--reps N] [--points N] [--rays N] [--out results.json]
+
+#include "juliaCPU.h"
+#include "juliaSIMD.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+// the default constant plus the ones left commented out at the top of juliaSet.frag
+static const glm::vec4 benchConstants[] = {
+	glm::vec4(-0.04f,  0.95f,  0.40f, -0.43f),
+	glm::vec4( 0.15f, -0.85f,  0.50f, -0.20f),
+	glm::vec4(-0.45f,  0.80f,  0.15f,  0.30f),
+	glm::vec4( 0.50f,  0.20f, -0.75f,  0.25f),
+	glm::vec4(-0.60f, -0.20f,  0.80f, -0.10f),
+	glm::vec4( 0.10f, -0.50f,  0.60f,  0.00f),
+};
+static const int benchIterations[] = { 20, 80, 200 };
+static const float benchEpsilons[] = { 1e-2f, 1e-3f, 1e-4f };
+
+struct benchResult
+{
+	std::string name;
+	std::string isa;
+	glm::vec4 constant;
+	int maxIterations;
+	float epsilon;          // < 0 when the case does not depend on it
+	long long items;        // work items per repetition
+	std::vector<double> ms; // one entry per repetition
+};
+
+// small deterministic generator so every run benchmarks the same points
+static float nextRandom(uint32_t& state)
+{
+	state = state * 1664525u + 1013904223u;
+	return static_cast<float>(state >> 8) / 16777216.0f;
+}
+
+static glm::vec3 randomInSphere(uint32_t& state, float radius)
+{
+	while (true)
+	{
+		glm::vec3 p(nextRandom(state) * 2.0f - 1.0f, nextRandom(state) * 2.0f - 1.0f, nextRandom(state) * 2.0f - 1.0f);
+		if (glm::dot(p, p) <= 1.0f)
+			return p * radius;
+	}
+}
+
+static std::vector<double> timeRuns(int reps, const std::function<void()>& run)
+{
+	run(); // warm up caches and the allocator
+
+	std::vector<double> ms;
+	for (int r = 0; r < reps; r++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		run();
+		auto end = std::chrono::steady_clock::now();
+		ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	return ms;
+}
+
+static double percentile(std::vector<double> values, double p)
+{
+	if (values.empty())
+		return 0.0;
+	std::sort(values.begin(), values.end());
+	size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+	return values[std::min(index, values.size() - 1)];
+}
+
+// rays from the canonical camera through random pixels, already moved onto the bounding sphere
+static std::vector<Ray> makeRays(int count)
+{
+	uint32_t state = 7u;
+	const glm::vec3 camPos(0.0f, 0.0f, 3.0f);
+
+	std::vector<Ray> rays;
+	while (static_cast<int>(rays.size()) < count)
+	{
+		glm::vec3 target = camPos + glm::vec3(nextRandom(state) * 1.2f - 0.6f, nextRandom(state) * 1.2f - 0.6f, -1.0f);
+		Ray r;
+		r.dir = glm::normalize(target - camPos);
+		r.origin = camPos;
+
+		float t = intersectBoundingSphere(r.origin, r.dir);
+		if (t > 0.0f)
+		{
+			r.origin += r.dir * t;
+			rays.push_back(r);
+		}
+	}
+	return rays;
+}
+
+static std::string toJSON(const std::vector<benchResult>& results, int reps)
+{
+	std::ostringstream out;
+	out << "{\n  \"cpu_isa\": \"" << isaName(detectISA()) << "\",\n  \"reps\": " << reps << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const benchResult& r = results[i];
+		const double medianMs = percentile(r.ms, 0.5);
+		const double p95Ms = percentile(r.ms, 0.95);
+
+		out << "    { \"bench\": \"" << r.name << "\", \"isa\": \"" << r.isa << "\""
+			<< ", \"constant\": [" << r.constant.x << ", " << r.constant.y << ", " << r.constant.z << ", " << r.constant.w << "]"
+			<< ", \"maxIterations\": " << r.maxIterations
+			<< ", \"epsilon\": ";
+		if (r.epsilon < 0.0f) out << "null"; else out << r.epsilon;
+		out << ", \"items\": " << r.items
+			<< ", \"median_ms\": " << medianMs
+			<< ", \"p95_ms\": " << p95Ms
+			<< ", \"median_per_sec\": " << (medianMs > 0.0 ? r.items * 1000.0 / medianMs : 0.0)
+			<< ", \"p95_per_sec\": " << (p95Ms > 0.0 ? r.items * 1000.0 / p95Ms : 0.0)
+			<< " }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}\n";
+	return out.str();
+}
+
+int main(int argc, char** argv)
+{
+	int reps = 15;
+	int pointCount = 1 << 14;
+	int rayCount = 256;
+	std::string outPath;
+
+	const char* usage = "usage: bench [--reps N] [--points N] [--rays N] [--out results.json]";
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "missing value for " << arg << std::endl;
+			std::cerr << usage << std::endl;
+			return -1;
+		}
+		i++;
+
+		if (strcmp(arg, "--reps") == 0) reps = std::max(1, atoi(value));
+		else if (strcmp(arg, "--points") == 0) pointCount = std::max(1, atoi(value));
+		else if (strcmp(arg, "--rays") == 0) rayCount = std::max(1, atoi(value));
+		else if (strcmp(arg, "--out") == 0) outPath = value;
+		else
+		{
+			std::cerr << usage << std::endl;
+			return -1;
+		}
+	}
+
+	std::vector<simdISA> isas;
+	for (simdISA isa : { simdISA::scalar, simdISA::sse4, simdISA::avx2, simdISA::avx512 })
+		if (isa <= detectISA())
+			isas.push_back(isa);
+
+	// points in the bounding sphere, already rotated into quaternion space
+	std::vector<glm::vec4> points(pointCount);
+	uint32_t state = 1u;
+	for (glm::vec4& p : points)
+		p = glm::vec4(randomInSphere(state, BOUNDING_SPHERE_RADIUS), 0.0f);
+
+	const std::vector<Ray> rays = makeRays(rayCount);
+
+	std::vector<benchResult> results;
+	std::vector<float> lanes(static_cast<size_t>(pointCount) * 8);
+
+	for (const glm::vec4& c : benchConstants)
+	{
+		for (int iterations : benchIterations)
+		{
+			for (simdISA isa : isas)
+			{
+				benchResult r = { "iterate", isaName(isa), c, iterations, -1.0f, pointCount, {} };
+				r.ms = timeRuns(reps, [&]
+				{
+					float* base = lanes.data();
+					quatLanes q = { base, base + pointCount, base + 2 * pointCount, base + 3 * pointCount };
+					quatLanes qp = { base + 4 * pointCount, base + 5 * pointCount, base + 6 * pointCount, base + 7 * pointCount };
+					for (int i = 0; i < pointCount; i++)
+					{
+						q.x[i] = points[i].x; q.y[i] = points[i].y; q.z[i] = points[i].z; q.w[i] = points[i].w;
+						qp.x[i] = 1.0f; qp.y[i] = 0.0f; qp.z[i] = 0.0f; qp.w[i] = 0.0f;
+					}
+					iterateIntersectLanes(q, qp, pointCount, c, iterations, isa);
+				});
+				results.push_back(r);
+			}
+
+			for (float epsilon : benchEpsilons)
+			{
+				juliaFrame frame;
+				frame.set.juliaConstant = c;
+				frame.set.maxIterations = iterations;
+				frame.set.epsilon = epsilon;
+
+				// the hit points of this configuration feed the normal benchmark
+				std::vector<glm::vec3> hits;
+				for (Ray ray : rays)
+					if (distanceEstimate(frame, ray) <= epsilon)
+						hits.push_back(ray.origin);
+
+				benchResult march = { "march", "scalar", c, iterations, epsilon, rayCount, {} };
+				march.ms = timeRuns(reps, [&]
+				{
+					volatile float sink = 0.0f;
+					for (Ray ray : rays)
+						sink = sink + distanceEstimate(frame, ray);
+				});
+				results.push_back(march);
+
+				if (hits.empty())
+					continue;
+
+				for (int method = 0; method < static_cast<int>(normalMethod::count); method++)
+				{
+					frame.set.normalMode = method;
+					benchResult normal = { std::string("normal_") + normalMethodNames[method], "scalar", c, iterations, epsilon, static_cast<long long>(hits.size()), {} };
+					normal.ms = timeRuns(reps, [&]
+					{
+						volatile float sink = 0.0f;
+						for (const glm::vec3& p : hits)
+							sink = sink + surfaceNormal(frame, p).x;
+					});
+					results.push_back(normal);
+				}
+			}
+
+			std::cerr << "constant (" << c.x << ", " << c.y << ", " << c.z << ", " << c.w << ") iterations " << iterations << " done" << std::endl;
+		}
+	}
+
+	const std::string json = toJSON(results, reps);
+	if (outPath.empty())
+	{
+		std::cout << json;
+	}
+	else
+	{
+		std::ofstream file(outPath);
+		if (!file)
+		{
+			std::cerr << "failed to open " << outPath << std::endl;
+			return -1;
+		}
+		file << json;
+	}
+
+	return 0;
+}
@@ -0,0 +1,141 @@
+#include "blueNoise.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// width of the gaussian that measures how clustered the points around a texel are
+static const float CLUSTER_SIGMA = 1.5f;
+
+// void-and-cluster over a toroidal grid
+// energy[i] is the gaussian weighted number of points around texel i, the tightest cluster is the point
+// with the most energy and the largest void the empty texel with the least
+class voidAndCluster
+{
+public:
+	voidAndCluster()
+		: points(TEXELS, 0), energy(TEXELS, 0.0f), weights(TEXELS)
+	{
+		// gaussian by toroidal offset, so adding a point is one pass over the grid
+		for (int y = 0; y < BLUE_NOISE_SIZE; y++)
+		{
+			for (int x = 0; x < BLUE_NOISE_SIZE; x++)
+			{
+				const float dx = static_cast<float>(std::min(x, BLUE_NOISE_SIZE - x));
+				const float dy = static_cast<float>(std::min(y, BLUE_NOISE_SIZE - y));
+				weights[y * BLUE_NOISE_SIZE + x] = std::exp(-(dx * dx + dy * dy) / (2.0f * CLUSTER_SIGMA * CLUSTER_SIGMA));
+			}
+		}
+	}
+
+	// rank of every texel divided by the texel count
+	std::vector<float> generate(uint32_t seed)
+	{
+		std::vector<int> rank(TEXELS, 0);
+
+		// random initial points, about a tenth of the grid
+		const int initialCount = TEXELS / 10;
+		int placed = 0;
+		while (placed < initialCount)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			const int i = static_cast<int>((seed >> 8) % TEXELS);
+			if (!points[i])
+			{
+				toggle(i);
+				placed++;
+			}
+		}
+
+		// relax until moving the tightest cluster into the largest void puts it back where it was
+		while (true)
+		{
+			const int cluster = tightestCluster();
+			toggle(cluster);
+			const int hole = largestVoid();
+			toggle(hole);
+			if (hole == cluster)
+				break;
+		}
+		const std::vector<char> initial = points;
+		const std::vector<float> initialEnergy = energy;
+
+		// initial points ranked from the last removed down
+		for (int r = initialCount - 1; r >= 0; r--)
+		{
+			const int cluster = tightestCluster();
+			toggle(cluster);
+			rank[cluster] = r;
+		}
+
+		// then every empty texel, filling the largest void first
+		points = initial;
+		energy = initialEnergy;
+		for (int r = initialCount; r < TEXELS; r++)
+		{
+			const int hole = largestVoid();
+			toggle(hole);
+			rank[hole] = r;
+		}
+
+		std::vector<float> values(TEXELS);
+		for (int i = 0; i < TEXELS; i++)
+			values[i] = (static_cast<float>(rank[i]) + 0.5f) / TEXELS;
+		return values;
+	}
+
+private:
+	static const int TEXELS = BLUE_NOISE_SIZE * BLUE_NOISE_SIZE;
+
+	void toggle(int i)
+	{
+		points[i] = !points[i];
+		const float sign = points[i] ? 1.0f : -1.0f;
+		const int px = i % BLUE_NOISE_SIZE;
+		const int py = i / BLUE_NOISE_SIZE;
+		for (int y = 0; y < BLUE_NOISE_SIZE; y++)
+		{
+			const int wy = ((y - py + BLUE_NOISE_SIZE) % BLUE_NOISE_SIZE) * BLUE_NOISE_SIZE;
+			for (int x = 0; x < BLUE_NOISE_SIZE; x++)
+				energy[y * BLUE_NOISE_SIZE + x] += sign * weights[wy + (x - px + BLUE_NOISE_SIZE) % BLUE_NOISE_SIZE];
+		}
+	}
+
+	int tightestCluster() const
+	{
+		int best = -1;
+		for (int i = 0; i < TEXELS; i++)
+			if (points[i] && (best < 0 || energy[i] > energy[best]))
+				best = i;
+		return best;
+	}
+
+	int largestVoid() const
+	{
+		int best = -1;
+		for (int i = 0; i < TEXELS; i++)
+			if (!points[i] && (best < 0 || energy[i] < energy[best]))
+				best = i;
+		return best;
+	}
+
+	std::vector<char> points;
+	std::vector<float> energy;
+	std::vector<float> weights;
+};
+
+const std::vector<glm::vec2>& blueNoise()
+{
+	// magic static, safe to call from the render threads
+	static const std::vector<glm::vec2> tile = []
+	{
+		const std::vector<float> x = voidAndCluster().generate(1u);
+		const std::vector<float> y = voidAndCluster().generate(2u);
+
+		std::vector<glm::vec2> texels(x.size());
+		for (size_t i = 0; i < texels.size(); i++)
+			texels[i] = glm::vec2(x[i], y[i]);
+		return texels;
+	}();
+	return tile;
+}
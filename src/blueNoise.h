@@ -0,0 +1,13 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// edge of the tile, the pattern wraps so pixel (x, y) reads texel (x % BLUE_NOISE_SIZE, y % BLUE_NOISE_SIZE)
+static const int BLUE_NOISE_SIZE = 64;
+
+// two independent channels of tileable blue noise, values in [0, 1) spread evenly over the tile
+// generated once on first use with void-and-cluster, deterministic so every run and renderer sees the same tile
+// row major, BLUE_NOISE_SIZE * BLUE_NOISE_SIZE texels
+const std::vector<glm::vec2>& blueNoise();
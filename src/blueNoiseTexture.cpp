@@ -0,0 +1,29 @@
+#include "blueNoiseTexture.h"
+#include "blueNoise.h"
+
+blueNoiseTexture::blueNoiseTexture()
+	: tex(0)
+{
+	const std::vector<glm::vec2>& texels = blueNoise();
+
+	glGenTextures(1, &tex);
+	glBindTexture(GL_TEXTURE_2D, tex);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG32F, BLUE_NOISE_SIZE, BLUE_NOISE_SIZE);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, BLUE_NOISE_SIZE, BLUE_NOISE_SIZE, GL_RG, GL_FLOAT, texels.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+blueNoiseTexture::~blueNoiseTexture()
+{
+	if (tex)
+		glDeleteTextures(1, &tex);
+}
+
+void blueNoiseTexture::bind() const
+{
+	glActiveTexture(GL_TEXTURE0 + BLUE_NOISE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, tex);
+	glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "common.h"
+
+// texture unit the fractal programs read the per pixel scramble from (blueNoise in juliaCommon.glsl)
+static const unsigned int BLUE_NOISE_UNIT = 6;
+
+// blueNoise() uploaded once, the same tile the CPU renderer scrambles its samples with
+class blueNoiseTexture
+{
+public:
+	blueNoiseTexture();
+	~blueNoiseTexture();
+
+	blueNoiseTexture(const blueNoiseTexture&) = delete;
+	blueNoiseTexture& operator=(const blueNoiseTexture&) = delete;
+
+	// nothing else uses the unit, binding once at startup is enough
+	void bind() const;
+private:
+	GLuint tex;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// fixed capacity FIFO between two pipeline stages, push waits while it is full and pop while it is empty
+// so a fast stage runs at most capacity items ahead of a slow one
+// close() ends the stream: pushes fail from then on, pops drain what is left and then return false
+template <typename T>
+class boundedQueue
+{
+public:
+	explicit boundedQueue(size_t capacity)
+		: maxItems(std::max<size_t>(capacity, 1)), closed(false)
+	{
+	}
+
+	boundedQueue(const boundedQueue&) = delete;
+	boundedQueue& operator=(const boundedQueue&) = delete;
+
+	bool push(T item)
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		notFull.wait(guard, [this] { return closed || items.size() < maxItems; });
+		if (closed)
+			return false;
+		items.push_back(std::move(item));
+		notEmpty.notify_one();
+		return true;
+	}
+
+	// never waits, returns false and leaves item alone if the queue is full or closed
+	bool tryPush(T& item)
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (closed || items.size() >= maxItems)
+			return false;
+		items.push_back(std::move(item));
+		notEmpty.notify_one();
+		return true;
+	}
+
+	bool pop(T& item)
+	{
+		std::unique_lock<std::mutex> guard(lock);
+		notEmpty.wait(guard, [this] { return closed || !items.empty(); });
+		if (items.empty())
+			return false;
+		item = std::move(items.front());
+		items.pop_front();
+		notFull.notify_one();
+		return true;
+	}
+
+	void close()
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		closed = true;
+		notFull.notify_all();
+		notEmpty.notify_all();
+	}
+private:
+	const size_t maxItems;
+	std::deque<T> items;
+	std::mutex lock;
+	std::condition_variable notFull;
+	std::condition_variable notEmpty;
+	bool closed;
+};
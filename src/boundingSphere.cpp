@@ -0,0 +1,122 @@
+#include "boundingSphere.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+float tightBoundingRadius(const juliaSettings& set, threadPool& pool, int rows, int grid)
+{
+	juliaFrame frame;
+	frame.set = set;
+
+	// footprint thresholds grow with the distance travelled, no ray inside the loose sphere gets further than its far side
+	const bool footprint = set.epsilonMode == static_cast<int>(epsilonMethod::footprint);
+	if (footprint && rows <= 0)
+		return BOUNDING_SPHERE_RADIUS;
+	if (footprint)
+		frame.pixelAngle = pixelAngle(1.0f / std::tan(glm::radians(set.fov) * 0.5f), static_cast<float>(rows));
+
+	const float cell = 2.0f * BOUNDING_SPHERE_RADIUS / grid;
+	const float halfDiagonal = 0.5f * std::sqrt(3.0f) * cell;
+	const float occupied = 2.0f * halfDiagonal + hitEpsilon(frame, CAMERA_DISTANCE + BOUNDING_SPHERE_RADIUS);
+
+	// one z slice per work item, each keeps the largest centre distance it found
+	std::vector<float> sliceRadius(grid, -1.0f);
+	pool.parallelFor(grid, [&](int z)
+	{
+		const float pz = -BOUNDING_SPHERE_RADIUS + (z + 0.5f) * cell;
+		float largest = -1.0f;
+		for (int y = 0; y < grid; y++)
+		{
+			const float py = -BOUNDING_SPHERE_RADIUS + (y + 0.5f) * cell;
+			for (int x = 0; x < grid; x++)
+			{
+				const glm::vec3 p(-BOUNDING_SPHERE_RADIUS + (x + 0.5f) * cell, py, pz);
+				const float r = glm::length(p);
+				// cells wholly outside the loose sphere are never marched, and inner ones cannot grow the radius
+				if (r - halfDiagonal > BOUNDING_SPHERE_RADIUS || r <= largest)
+					continue;
+				if (distanceBound(frame, p) < occupied)
+					largest = r;
+			}
+		}
+		sliceRadius[z] = largest;
+	});
+
+	const float largest = *std::max_element(sliceRadius.begin(), sliceRadius.end());
+	if (largest < 0.0f)
+		return BOUNDING_SPHERE_RADIUS;     // nothing found, the grid is too coarse for this set, stay loose
+	return std::min(largest + halfDiagonal + cell, BOUNDING_SPHERE_RADIUS);
+}
+
+bool boundingRadiusStale(const juliaSettings& was, int wasRows, const juliaSettings& now, int nowRows)
+{
+	if (changedFields(was, now) & BOUNDING_FIELDS)
+		return true;
+	return now.epsilonMode == static_cast<int>(epsilonMethod::footprint) && (was.fov != now.fov || wasRows != nowRows);
+}
+
+boundingSphereUpdater::boundingSphereUpdater(unsigned threadCount)
+	: pool(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency() / 2)),
+	pendingRows(0), requested(0), started(0), finished(-1), result(BOUNDING_SPHERE_RADIUS), stopping(false)
+{
+	worker = std::thread(&boundingSphereUpdater::workerLoop, this);
+}
+
+boundingSphereUpdater::~boundingSphereUpdater()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	worker.join();
+}
+
+void boundingSphereUpdater::request(const juliaSettings& set, int rows)
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		pendingSet = set;
+		pendingRows = rows;
+		requested++;
+	}
+	wake.notify_all();
+}
+
+bool boundingSphereUpdater::poll(float& radius)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	if (finished != requested)
+		return false;
+	radius = result;
+	finished = -1;
+	return true;
+}
+
+void boundingSphereUpdater::workerLoop()
+{
+	std::unique_lock<std::mutex> guard(lock);
+	while (true)
+	{
+		wake.wait(guard, [this] { return stopping || started != requested; });
+		if (stopping)
+			return;
+
+		const juliaSettings set = pendingSet;
+		const int rows = pendingRows;
+		const long long generation = requested;
+		started = generation;
+
+		guard.unlock();
+		const float radius = tightBoundingRadius(set, pool, rows);
+		guard.lock();
+
+		// a newer request arrived meanwhile, its own pass replaces this one
+		if (generation == requested)
+		{
+			result = radius;
+			finished = generation;
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "juliaCPU.h"
+#include "camera.h"
+#include "threadPool.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// settings tightBoundingRadius depends on, the radius has to be measured again when one of them changes
+// under epsilonMethod::footprint the fov and the rendered rows count too, see boundingRadiusStale
+static const unsigned BOUNDING_FIELDS = FIELD_JULIA_CONSTANT | FIELD_MAX_ITERATIONS | FIELD_EPSILON | FIELD_EPSILON_MODE;
+
+// cells per axis of the coarse grid tightBoundingRadius samples over the BOUNDING_SPHERE_RADIUS cube
+static const int BOUNDING_GRID = 64;
+
+// radius of a sphere around the origin that holds every point the march can hit for these settings
+// kept centred on the origin so it stays valid under any rotation of the set
+// a grid cell counts as occupied while the distance bound at its centre is below twice its half diagonal
+// (the bound is only approximate) plus the hit threshold, the radius covers every occupied cell plus one more cell
+// never more than BOUNDING_SPHERE_RADIUS
+// rows is the height rendered at, under epsilonMethod::footprint the threshold is taken at the far side of the
+// loose sphere for set.fov and rows, without rows (0) footprint mode stays on BOUNDING_SPHERE_RADIUS
+float tightBoundingRadius(const juliaSettings& set, threadPool& pool, int rows, int grid = BOUNDING_GRID);
+
+// a radius measured for was at wasRows does not hold for now at nowRows
+bool boundingRadiusStale(const juliaSettings& was, int wasRows, const juliaSettings& now, int nowRows);
+
+// runs tightBoundingRadius off the render thread while the constant is dragged around
+// only the newest request matters, older ones are dropped once a newer one arrives
+class boundingSphereUpdater
+{
+public:
+	explicit boundingSphereUpdater(unsigned threadCount = 0);   // 0 = half the hardware threads
+	~boundingSphereUpdater();
+
+	boundingSphereUpdater(const boundingSphereUpdater&) = delete;
+	boundingSphereUpdater& operator=(const boundingSphereUpdater&) = delete;
+
+	void request(const juliaSettings& set, int rows);
+
+	// true once when the radius for the latest request is ready
+	bool poll(float& radius);
+private:
+	void workerLoop();
+
+	threadPool pool;
+	std::thread worker;
+	std::mutex lock;
+	std::condition_variable wake;
+	juliaSettings pendingSet;
+	int pendingRows;
+	long long requested;    // generation of the latest request
+	long long started;      // generation the worker picked up last
+	long long finished;     // generation result belongs to, -1 once it has been polled
+	float result;
+	bool stopping;
+};
@@ -1,9 +1,13 @@
 #pragma once
 
-#include "common.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 
-#include "shader.h"
+// the canonical camera sits this far from the origin, looking at it
+static const float CAMERA_DISTANCE = 3.0f;
 
+// view the renderers march from, plain math so the CPU tools need no GL headers
+// juliaParams::setCamera uploads it for the shaders
 class camera
 {
 public:
@@ -12,10 +16,12 @@ public:
 
 	void updateResolution(float w, float h) { resolution.x = w; resolution.y = h; };
 
-	void setUniforms(shader* pShader) const;
-	glm::mat3 rotationMat();
+	glm::mat3 rotationMat() const;
 
 	glm::vec2 getResolution() const { return resolution; };
+	glm::vec3 getEye() const { return eye; };
+	glm::vec3 getLookAt() const { return lookAt; };
+	glm::vec3 getUp() const { return up; };
 
 
 	float yaw;
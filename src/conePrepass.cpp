@@ -0,0 +1,30 @@
+#include "conePrepass.h"
+
+conePrepass::conePrepass()
+	: prepassShader("shaders/conePrepass.comp"), depthTarget({ GL_R32F }), block(0)
+{
+}
+
+bool conePrepass::update(int renderWidth, int renderHeight, int blockSize, bool paramsChanged)
+{
+	if (!valid() || blockSize <= 0)
+		return false;
+
+	const bool resized = depthTarget.resize((renderWidth + blockSize - 1) / blockSize, (renderHeight + blockSize - 1) / blockSize);
+	if (!resized && !paramsChanged && blockSize == block)
+		return false;
+	block = blockSize;
+
+	prepassShader.bindComp();
+	glBindImageTexture(CONE_DEPTH_UNIT, depthTarget.texture(0), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+	prepassShader.dispatchCompute(depthTarget.width(), depthTarget.height());
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	return true;
+}
+
+void conePrepass::bind() const
+{
+	glActiveTexture(GL_TEXTURE0 + CONE_DEPTH_UNIT);
+	glBindTexture(GL_TEXTURE_2D, depthTarget.texture(0));
+	glActiveTexture(GL_TEXTURE0);
+}
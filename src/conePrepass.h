@@ -0,0 +1,31 @@
+#pragma once
+
+#include "shader.h"
+#include "renderTarget.h"
+
+// texture unit the fractal programs read the start distances from (coneDepth in juliaCommon.glsl)
+static const unsigned int CONE_DEPTH_UNIT = 1;
+
+// marches one conservative cone per block of pixels into a small float texture
+// the full resolution pass starts each ray at its block's distance instead of on the bounding sphere
+class conePrepass
+{
+public:
+	conePrepass();
+
+	conePrepass(const conePrepass&) = delete;
+	conePrepass& operator=(const conePrepass&) = delete;
+
+	// runs the pass when the block grid changes or paramsChanged is set, returns true if it ran
+	// the juliaParams block must already be uploaded
+	bool update(int renderWidth, int renderHeight, int blockSize, bool paramsChanged);
+
+	// makes the distances visible to the fractal programs
+	void bind() const;
+
+	bool valid() const { return prepassShader.getComp_ID() != 0; };
+private:
+	shader prepassShader;
+	renderTarget depthTarget;
+	int block;
+};
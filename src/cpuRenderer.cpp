@@ -0,0 +1,373 @@
+#include "cpuRenderer.h"
+#include "blueNoise.h"
+#include "boundingSphere.h"
+
+#include <atomic>
+#include <cstdint>
+
+cpuRenderer::cpuRenderer(unsigned threadCount)
+    : tileSize(16), isa(detectISA()), tightBounds(true), sampleOffset(0), pool(threadCount), lastStats(), boundsRows(0), boundsRadius(-1.0f)
+{
+}
+
+cpuRenderer::~cpuRenderer()
+{
+
+}
+
+static float fract(float x)
+{
+    return x - std::floor(x);
+}
+
+// first two dimensions of the Sobol sequence as 32 bit fractions, the first is the van der Corput sequence
+static glm::uvec2 sobol2(uint32_t i)
+{
+    glm::uvec2 r(0u);
+    uint32_t v = 0x80000000u;
+    for (int bit = 0; bit < 32 && i != 0u; bit++, i >>= 1)
+    {
+        if (i & 1u)
+        {
+            r.x ^= 0x80000000u >> bit;
+            r.y ^= v;
+        }
+        v ^= v >> 1;
+    }
+    return r;
+}
+
+// sampleJitter() in juliaCommon.glsl, position of sample s inside pixel (x, y) in [0, 1)
+static glm::vec2 sampleJitter(int pattern, int x, int y, const glm::vec2& UV, int s)
+{
+    if (pattern == static_cast<int>(sampleSequence::hash))
+    {
+        return glm::vec2(
+            fract(std::sin(glm::dot(UV, glm::vec2(12.9898f, 78.233f)) + float(s)) * 43758.5453f),
+            fract(std::sin(glm::dot(UV, glm::vec2(39.3461f, 11.135f)) + float(s)) * 91173.1224f));
+    }
+
+    const glm::vec2 noise = blueNoise()[(y % BLUE_NOISE_SIZE) * BLUE_NOISE_SIZE + x % BLUE_NOISE_SIZE];
+    if (pattern == static_cast<int>(sampleSequence::sobol))
+    {
+        // XOR scrambling keeps every power of two prefix stratified
+        const glm::uvec2 sobol = sobol2(static_cast<uint32_t>(s));
+        const uint32_t bx = sobol.x ^ static_cast<uint32_t>(noise.x * 4294967296.0f);
+        const uint32_t by = sobol.y ^ static_cast<uint32_t>(noise.y * 4294967296.0f);
+        return glm::vec2(float(bx >> 8), float(by >> 8)) / 16777216.0f;
+    }
+
+    // R2, the 2D golden ratio sequence
+    const glm::vec2 alpha(0.7548776662466927f, 0.5698402909980532f);
+    const glm::vec2 p = noise + alpha * float(s);
+    return glm::vec2(fract(p.x), fract(p.y));
+}
+
+// direction of the primary ray through uv
+static glm::vec3 cameraRayDir(const cpuView& view, const glm::vec2& uv)
+{
+    glm::vec2 ndc = uv * 2.0f - 1.0f;
+    glm::vec3 target = view.camPos
+                     + view.focal * view.camLookAt
+                     + ndc.x * view.aspect * view.camRight
+                     + ndc.y * view.camUp;
+    return glm::normalize(target - view.camPos);
+}
+
+// distanceEstimate for a whole batch of rays, the unfinished ones step together through the lane kernel
+// hitEps gets the threshold each ray was last tested against, negative for rays that spent maxMarchSteps
+// returns the number of distance evaluations
+static long long marchRays(const juliaFrame& frame, std::vector<Ray>& rays, std::vector<float>& dist, std::vector<float>& hitEps, simdISA isa)
+{
+    thread_local std::vector<int> active;
+    thread_local std::vector<float> px, py, pz, d;
+    thread_local std::vector<marchState> states;
+
+    dist.resize(rays.size());
+    hitEps.resize(rays.size());
+    active.clear();
+    states.resize(rays.size());
+    for (size_t i = 0; i < rays.size(); i++)
+    {
+        states[i] = beginMarch(frame, rays[i]);
+        dist[i] = 0.0f;
+        hitEps[i] = -1.0f;
+        if (frame.set.maxMarchSteps > 0)
+            active.push_back(static_cast<int>(i));
+    }
+
+    long long evaluations = 0;
+    while (!active.empty())
+    {
+        const size_t count = active.size();
+        px.resize(count); py.resize(count); pz.resize(count); d.resize(count);
+        for (size_t k = 0; k < count; k++)
+        {
+            const glm::vec3& o = rays[active[k]].origin;
+            px[k] = o.x; py[k] = o.y; pz[k] = o.z;
+        }
+
+        distanceBoundLanes(frame, px.data(), py.data(), pz.data(), d.data(), static_cast<int>(count), isa);
+        evaluations += count;
+
+        // advance every ray and keep the ones that neither hit, left the bounding sphere nor ran out of steps
+        size_t kept = 0;
+        for (size_t k = 0; k < count; k++)
+        {
+            const int i = active[k];
+            const marchResult result = marchStep(frame, rays[i], states[i], d[k], hitEps[i]);
+            dist[i] = d[k];
+
+            if (result == marchResult::running)
+                active[kept++] = i;
+            else if (result == marchResult::exhausted)
+                hitEps[i] = -1.0f;
+        }
+        active.resize(kept);
+    }
+    return evaluations;
+}
+
+// main() in juliaSet.frag for every pixel of the tile, run as one wavefront of samples
+// adaptive rounds march again as a smaller wavefront of the pixels that have not settled, returns the samples taken
+tileCounts cpuRenderer::renderTile(const juliaFrame& frame, const cpuView& view, int x0, int y0, int x1, int y1, std::vector<glm::vec3>& pixels) const
+{
+    tileCounts counts = {};
+
+    thread_local std::vector<Ray> rays, normRays;
+    thread_local std::vector<int> owner, hitOwner, pending;
+    thread_local std::vector<float> dist, hitEps, normDist, normEps, px, py, pz, coneT;
+    thread_local std::vector<glm::vec3> normals;
+    thread_local std::vector<sampleStats> stats;
+
+    const int samples = std::max(frame.set.aaSamples, 1);
+    const int budget = std::max(frame.set.maxAASamples, samples);
+    const int tileW = x1 - x0;
+    const int tileH = y1 - y0;
+
+    stats.assign(static_cast<size_t>(tileW) * tileH, sampleStats());
+    pending.resize(stats.size());
+    for (size_t i = 0; i < pending.size(); i++)
+        pending[i] = static_cast<int>(i);
+
+    // conePrepass.comp for the blocks this tile overlaps, blocks are aligned to the image not the tile
+    const int coneBlock = frame.set.coneBlock;
+    int bx0 = 0, by0 = 0, blocksX = 0;
+    if (coneBlock > 0)
+    {
+        bx0 = x0 / coneBlock;
+        by0 = y0 / coneBlock;
+        blocksX = (x1 - 1) / coneBlock - bx0 + 1;
+        const int blocksY = (y1 - 1) / coneBlock - by0 + 1;
+
+        coneT.resize(static_cast<size_t>(blocksX) * blocksY);
+        for (int by = 0; by < blocksY; by++)
+        {
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                glm::vec2 UV = (glm::vec2(float(bx0 + bx), float(by0 + by)) + 0.5f) * float(coneBlock) / view.resolution;
+                coneT[by * blocksX + bx] = coneStartDistance(frame, view.camPos, cameraRayDir(view, UV), view.coneSlope);
+            }
+        }
+    }
+
+    while (!pending.empty())
+    {
+        rays.clear();
+        owner.clear();
+
+        for (int local : pending)
+        {
+            const int x = x0 + local % tileW;
+            const int y = y0 + local / tileW;
+            glm::vec2 UV = (glm::vec2(float(x), float(y)) + 0.5f) / view.resolution;
+            const float start = coneBlock > 0 ? coneT[(y / coneBlock - by0) * blocksX + (x / coneBlock - bx0)] : 0.0f;
+
+            const int first = stats[local].count;
+            const int last = std::min(first + samples, budget);
+            for (int s = first; s < last; s++)
+            {
+                // jitter inside pixel
+                glm::vec2 jitter = sampleJitter(frame.set.samplePattern, x, y, UV, s + sampleOffset);
+
+                glm::vec2 uvJ = UV + (jitter - 0.5f) / view.resolution;
+
+                Ray ray;
+                ray.dir = cameraRayDir(view, uvJ);
+                ray.origin = view.camPos;
+
+                float t = intersectBoundingSphere(ray.origin, ray.dir, frame.boundingRadius);
+                if (t > 0.0f && start >= 0.0f)
+                {
+                    // move ray onto bounding sphere, or past the empty space the cone already crossed
+                    ray.origin += ray.dir * std::max(t, start);
+                    rays.push_back(ray);
+                    owner.push_back(local);
+                }
+                else
+                {
+                    // no hit with fractal
+                    stats[local].add(frame.set.backgroundColor, false, 0.0f);
+                }
+            }
+        }
+
+        counts.evaluations += marchRays(frame, rays, dist, hitEps, isa);
+        counts.rays += static_cast<long long>(rays.size());
+
+        hitOwner.clear();
+        for (size_t i = 0; i < rays.size(); i++)
+        {
+            if (hitEps[i] < 0.0f)
+                counts.exhausted++;
+            if (dist[i] <= hitEps[i])
+                hitOwner.push_back(static_cast<int>(i));
+            else
+                stats[owner[i]].add(frame.set.backgroundColor, false, 0.0f);
+        }
+
+        const normalMethod method = static_cast<normalMethod>(frame.set.normalMode);
+        normals.resize(hitOwner.size());
+
+        if (method == normalMethod::analytic)
+        {
+            for (size_t h = 0; h < hitOwner.size(); h++)
+                normals[h] = analyticNorm(frame, rays[hitOwner[h]].origin);
+        }
+        else if (method == normalMethod::tetrahedral)
+        {
+            // four direct bounds per hit, no marching, all taps of the tile through the lane kernel at once
+            const size_t tapCount = hitOwner.size() * 4;
+            px.resize(tapCount); py.resize(tapCount); pz.resize(tapCount); normDist.resize(tapCount);
+            for (size_t h = 0; h < hitOwner.size(); h++)
+            {
+                for (int k = 0; k < 4; k++)
+                {
+                    glm::vec3 p = rays[hitOwner[h]].origin + tetraTaps[k] * TETRA_NORMAL_OFFSET;
+                    px[h * 4 + k] = p.x; py[h * 4 + k] = p.y; pz[h * 4 + k] = p.z;
+                }
+            }
+
+            distanceBoundLanes(frame, px.data(), py.data(), pz.data(), normDist.data(), static_cast<int>(tapCount), isa);
+
+            for (size_t h = 0; h < hitOwner.size(); h++)
+            {
+                glm::vec3 n(0.0f);
+                for (int k = 0; k < 4; k++)
+                    n += tetraTaps[k] * normDist[h * 4 + k];
+                normals[h] = glm::normalize(n);
+            }
+        }
+        else
+        {
+            // six deAt marches per hit for the central difference normal, batched the same way
+            const float e = 0.001f;
+            const glm::vec3 offsets[3] = { glm::vec3(e, 0, 0), glm::vec3(0, e, 0), glm::vec3(0, 0, e) };
+
+            normRays.clear();
+            for (int hit : hitOwner)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    Ray r;
+                    r.dir = glm::vec3(1.0f, 0.0f, 0.0f);
+                    r.origin = rays[hit].origin + offsets[axis];
+                    normRays.push_back(r);
+                    r.origin = rays[hit].origin - offsets[axis];
+                    normRays.push_back(r);
+                }
+            }
+
+            marchRays(frame, normRays, normDist, normEps, isa);
+
+            for (size_t h = 0; h < hitOwner.size(); h++)
+            {
+                const float* nd = &normDist[h * 6];
+                normals[h] = glm::normalize(glm::vec3(nd[0] - nd[1], nd[2] - nd[3], nd[4] - nd[5]));
+            }
+        }
+
+        for (size_t h = 0; h < hitOwner.size(); h++)
+        {
+            const Ray& hit = rays[hitOwner[h]];
+            stats[owner[hitOwner[h]]].add(shadePhong(frame, frame.set.lightPos, hit.origin, normals[h]), true, glm::length(hit.origin - view.camPos));
+        }
+
+        // only the pixels that have neither settled nor spent the budget go into the next round
+        size_t kept = 0;
+        for (int local : pending)
+            if (stats[local].count < budget && !stats[local].settled(frame.set.aaThreshold))
+                pending[kept++] = local;
+        pending.resize(kept);
+    }
+
+    const size_t rowPitch = static_cast<size_t>(view.resolution.x);
+    for (int y = y0; y < y1; y++)
+    {
+        for (int x = x0; x < x1; x++)
+        {
+            const sampleStats& st = stats[(y - y0) * tileW + (x - x0)];
+            pixels[y * rowPitch + x] = st.sum / float(st.count);
+            counts.samples += st.count;
+        }
+    }
+    return counts;
+}
+
+void cpuRenderer::render(const juliaSettings& set, const camera& cam, std::vector<glm::vec3>& pixels)
+{
+    const glm::vec2 resolution = cam.getResolution();
+    const int width = static_cast<int>(resolution.x);
+    const int height = static_cast<int>(resolution.y);
+    pixels.resize(static_cast<size_t>(width) * height);
+    if (width <= 0 || height <= 0)
+        return;
+
+    juliaFrame frame;
+    frame.set = set;
+    frame.rotation = cam.rotationMat();
+    frame.camPos = cam.getEye();
+
+    // measured once per constant (and height under footprint epsilons), every frame after that reuses it
+    if (tightBounds)
+    {
+        if (boundsRadius < 0.0f || boundingRadiusStale(boundsSet, boundsRows, set, height))
+        {
+            boundsRadius = tightBoundingRadius(set, pool, height);
+            boundsSet = set;
+            boundsRows = height;
+        }
+        frame.boundingRadius = boundsRadius;
+    }
+
+    cpuView view;
+    view.camPos = cam.getEye();
+    view.camLookAt = cam.getLookAt();
+    view.camUp = cam.getUp();
+    view.camRight = glm::normalize(glm::cross(view.camLookAt, view.camUp));
+    view.resolution = resolution;
+    view.aspect = resolution.x / resolution.y;
+    view.focal = 1.0f / std::tan(glm::radians(set.fov) * 0.5f);
+    view.coneSlope = coneSlope(set.coneBlock, view.focal, resolution.y);
+    frame.pixelAngle = pixelAngle(view.focal, resolution.y);
+
+    const int tile = std::max(tileSize, 1);
+    const int tilesX = (width + tile - 1) / tile;
+    const int tilesY = (height + tile - 1) / tile;
+
+    std::atomic<long long> samples(0), rays(0), evaluations(0), exhausted(0);
+    pool.parallelFor(tilesX * tilesY, [&](int tileIndex)
+    {
+        const int x0 = (tileIndex % tilesX) * tile;
+        const int y0 = (tileIndex / tilesX) * tile;
+        const tileCounts counts = renderTile(frame, view, x0, y0, std::min(x0 + tile, width), std::min(y0 + tile, height), pixels);
+        samples += counts.samples;
+        rays += counts.rays;
+        evaluations += counts.evaluations;
+        exhausted += counts.exhausted;
+    });
+    lastStats.samplesPerPixel = static_cast<float>(samples.load() / (static_cast<double>(width) * height));
+    lastStats.evaluationsPerRay = rays.load() ? static_cast<float>(evaluations.load() / static_cast<double>(rays.load())) : 0.0f;
+    lastStats.exhaustedRays = exhausted.load();
+    lastStats.boundingRadius = frame.boundingRadius;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "juliaCPU.h"
+#include "juliaSIMD.h"
+#include "threadPool.h"
+#include "camera.h"
+
+// camera basis the fragment shader rebuilds per pixel, computed once per frame
+struct cpuView
+{
+	glm::vec3 camPos;
+	glm::vec3 camLookAt;
+	glm::vec3 camUp;
+	glm::vec3 camRight;
+	glm::vec2 resolution;
+	float aspect;
+	float focal;
+	float coneSlope;    // only used while set.coneBlock > 0
+};
+
+// what the last frame cost, primary rays only
+struct renderStats
+{
+	float samplesPerPixel;      // above aaSamples when adaptive sampling refined edges
+	float evaluationsPerRay;    // distance bounds per marched ray
+	long long exhaustedRays;    // rays that spent maxMarchSteps and were drawn as misses
+	float boundingRadius;       // sphere the rays started on
+};
+
+// work done by one tile, summed into renderStats
+struct tileCounts
+{
+	long long samples;
+	long long rays;
+	long long evaluations;
+	long long exhausted;
+};
+
+// renders juliaSet.frag on the CPU, the frame is split into square tiles that are spread across a work stealing pool
+// inside a tile all samples march together so distance evaluations run through the SIMD lane kernel
+class cpuRenderer
+{
+public:
+	explicit cpuRenderer(unsigned threadCount = 0); // 0 = all cores
+	~cpuRenderer();
+
+	// pixels is resized to width * height, row 0 is the bottom row like glReadPixels
+	void render(const juliaSettings& set, const camera& cam, std::vector<glm::vec3>& pixels);
+
+	unsigned threadCount() const { return pool.size(); };
+	const renderStats& stats() const { return lastStats; };
+
+	int tileSize;
+	simdISA isa;    // defaults to the best the cpu supports
+	bool tightBounds;   // march inside tightBoundingRadius instead of BOUNDING_SPHERE_RADIUS, on by default
+	int sampleOffset;   // index of the first sample, like the sampleOffset uniform of the GPU paths
+private:
+	tileCounts renderTile(const juliaFrame& frame, const cpuView& view, int x0, int y0, int x1, int y1, std::vector<glm::vec3>& pixels) const;
+
+	threadPool pool;
+	renderStats lastStats;
+	juliaSettings boundsSet;    // settings boundsRadius was measured for
+	int boundsRows;             // and the height
+	float boundsRadius;         // < 0 until the first measurement
+};
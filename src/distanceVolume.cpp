@@ -0,0 +1,134 @@
+#include "distanceVolume.h"
+
+#include <algorithm>
+#include <cmath>
+
+static GLuint createVolumeTexture(GLenum format, int width, int height, int depth, GLenum filter)
+{
+	GLuint tex = 0;
+	glGenTextures(1, &tex);
+	glBindTexture(GL_TEXTURE_3D, tex);
+	glTexStorage3D(GL_TEXTURE_3D, 1, format, width, height, depth);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_3D, 0);
+	return tex;
+}
+
+distanceVolume::distanceVolume()
+	: classifyShader("shaders/classifyBricks.comp"), bakeShader("shaders/bakeBricks.comp"),
+	centreTexture(0), mapTexture(0), atlasTexture(0), brickList(0), atlasSlots(0), slotCount(0), volumeRadius(0.0f), baked(false)
+{
+	centreTexture = createVolumeTexture(GL_R32F, VOLUME_BRICKS, VOLUME_BRICKS, VOLUME_BRICKS, GL_NEAREST);
+	mapTexture = createVolumeTexture(GL_RG32F, VOLUME_BRICKS, VOLUME_BRICKS, VOLUME_BRICKS, GL_NEAREST);
+	glGenBuffers(1, &brickList);
+}
+
+distanceVolume::~distanceVolume()
+{
+	glDeleteTextures(1, &centreTexture);
+	glDeleteTextures(1, &mapTexture);
+	if (atlasTexture)
+		glDeleteTextures(1, &atlasTexture);
+	glDeleteBuffers(1, &brickList);
+}
+
+bool distanceVolume::bake(float radius)
+{
+	if (!valid())
+		return false;
+
+	const float cell = 2.0f * radius / (VOLUME_BRICKS * VOLUME_BRICK_CELLS);
+	const int groups = (VOLUME_BRICKS + 3) / 4;
+
+	classifyShader.bindComp();
+	classifyShader.setUniform1f("volumeOrigin", -radius);
+	classifyShader.setUniform1f("cellSize", cell);
+	glBindImageTexture(0, centreTexture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R32F);
+	glDispatchCompute(groups, groups, groups);
+	glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+	std::vector<float> centres(VOLUME_BRICKS * VOLUME_BRICKS * VOLUME_BRICKS);
+	glBindTexture(GL_TEXTURE_3D, centreTexture);
+	glGetTexImage(GL_TEXTURE_3D, 0, GL_RED, GL_FLOAT, centres.data());
+
+	// a brick needs samples when the surface may reach it or come within the refine distance of it
+	// twice the half diagonal because the bound is only approximate, like tightBoundingRadius
+	const float halfDiagonal = 0.5f * std::sqrt(3.0f) * VOLUME_BRICK_CELLS * cell;
+	const float occupied = 2.0f * halfDiagonal + 2.0f * cell;
+
+	std::vector<glm::vec2> map(centres.size());
+	std::vector<glm::ivec4> bricks;
+	for (int z = 0; z < VOLUME_BRICKS; z++)
+	{
+		for (int y = 0; y < VOLUME_BRICKS; y++)
+		{
+			for (int x = 0; x < VOLUME_BRICKS; x++)
+			{
+				const size_t i = (static_cast<size_t>(z) * VOLUME_BRICKS + y) * VOLUME_BRICKS + x;
+				if (centres[i] < occupied)
+				{
+					map[i] = glm::vec2(static_cast<float>(bricks.size()), centres[i]);
+					bricks.push_back(glm::ivec4(x, y, z, 0));
+				}
+				else
+				{
+					map[i] = glm::vec2(-1.0f, centres[i]);
+				}
+			}
+		}
+	}
+
+	glBindTexture(GL_TEXTURE_3D, mapTexture);
+	glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, VOLUME_BRICKS, VOLUME_BRICKS, VOLUME_BRICKS, GL_RG, GL_FLOAT, map.data());
+	glBindTexture(GL_TEXTURE_3D, 0);
+
+	// near cubic block of slots, only reallocated when the brick count outgrows it
+	slotCount = static_cast<int>(bricks.size());
+	const int slotsPerEdge = std::max(1, static_cast<int>(std::ceil(std::cbrt(static_cast<double>(slotCount)))));
+	const glm::ivec3 slots(slotsPerEdge, slotsPerEdge, std::max(1, (slotCount + slotsPerEdge * slotsPerEdge - 1) / (slotsPerEdge * slotsPerEdge)));
+	if (!atlasTexture || slots != atlasSlots)
+	{
+		if (atlasTexture)
+			glDeleteTextures(1, &atlasTexture);
+		atlasSlots = slots;
+		const glm::ivec3 size = atlasSlots * (VOLUME_BRICK_CELLS + 1);
+		atlasTexture = createVolumeTexture(GL_R16F, size.x, size.y, size.z, GL_LINEAR);
+	}
+
+	if (slotCount > 0)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, brickList);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, bricks.size() * sizeof(glm::ivec4), bricks.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VOLUME_BRICK_LIST_BINDING, brickList);
+
+		bakeShader.bindComp();
+		bakeShader.setUniform1f("volumeOrigin", -radius);
+		bakeShader.setUniform1f("cellSize", cell);
+		bakeShader.setUniform1i("slotCount", slotCount);
+		glBindImageTexture(0, atlasTexture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R16F);
+		glDispatchCompute(atlasSlots.x, atlasSlots.y, atlasSlots.z);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+
+	glActiveTexture(GL_TEXTURE0 + VOLUME_MAP_UNIT);
+	glBindTexture(GL_TEXTURE_3D, mapTexture);
+	glActiveTexture(GL_TEXTURE0 + VOLUME_ATLAS_UNIT);
+	glBindTexture(GL_TEXTURE_3D, atlasTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	volumeRadius = radius;
+	baked = true;
+	return true;
+}
+
+size_t distanceVolume::bytes() const
+{
+	const glm::ivec3 atlas = atlasSlots * (VOLUME_BRICK_CELLS + 1);
+	return static_cast<size_t>(VOLUME_BRICKS) * VOLUME_BRICKS * VOLUME_BRICKS * sizeof(glm::vec2) +
+	       static_cast<size_t>(atlas.x) * atlas.y * atlas.z * 2;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "shader.h"
+
+// texture units the fractal programs read the baked volume from (brickMap / brickAtlas in juliaCommon.glsl)
+static const unsigned int VOLUME_MAP_UNIT = 7;
+static const unsigned int VOLUME_ATLAS_UNIT = 8;
+// shader storage binding of the slot -> brick list bakeBricks.comp reads
+static const unsigned int VOLUME_BRICK_LIST_BINDING = 1;
+// cells along one brick edge, BRICK_CELLS in juliaCommon.glsl
+static const int VOLUME_BRICK_CELLS = 8;
+// bricks along one volume edge, 256 cells in all
+static const int VOLUME_BRICKS = 32;
+// settings the baked distances depend on, the volume is stale once one of them changes
+static const unsigned VOLUME_FIELDS = FIELD_JULIA_CONSTANT | FIELD_MAX_ITERATIONS;
+
+// distanceBound of the current constant baked into a sparse brick map, in the set's own frame so any rotation reuses it
+// only bricks near the surface get samples, stored in a half float atlas, the rest keep the bound at their centre
+// the march steps through the volume and only runs the quaternion iteration close to the surface
+class distanceVolume
+{
+public:
+	distanceVolume();
+	~distanceVolume();
+
+	distanceVolume(const distanceVolume&) = delete;
+	distanceVolume& operator=(const distanceVolume&) = delete;
+
+	// bakes the constant of the uploaded juliaParams block over the cube of half edge radius and binds the result
+	// waits for one small readback of the brick centres to hand out atlas slots
+	bool bake(float radius);
+
+	// the constant changed, the fractal programs must stop reading the volume
+	void invalidate() { baked = false; };
+
+	bool ready() const { return baked; };
+	float radius() const { return volumeRadius; };
+	int brickCount() const { return slotCount; };
+	// GPU memory of the brick map and atlas
+	size_t bytes() const;
+
+	bool valid() const { return classifyShader.getComp_ID() != 0 && bakeShader.getComp_ID() != 0; };
+private:
+	shader classifyShader;
+	shader bakeShader;
+	GLuint centreTexture;   // VOLUME_BRICKS^3 bound at every brick centre
+	GLuint mapTexture;      // VOLUME_BRICKS^3 (slot, centre bound)
+	GLuint atlasTexture;
+	GLuint brickList;
+	glm::ivec3 atlasSlots;
+	int slotCount;
+	float volumeRadius;
+	bool baked;
+};
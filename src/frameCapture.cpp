@@ -0,0 +1,196 @@
+#include "frameCapture.h"
+#include "imageWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+frameCapture::frameCapture(int ringSize, int writerQueue)
+	: ring(std::max(ringSize, 2)), writeIndex(0), readIndex(0), active(false), session(0), capturedFrames(0), droppedFrames(0),
+	  jobs(static_cast<size_t>(std::max(writerQueue, 1))), writtenFrames(0), failedFrames(0)
+{
+	for (slot& s : ring)
+	{
+		glGenBuffers(1, &s.buffer);
+		s.fence = nullptr;
+		s.size = 0;
+		s.width = 0;
+		s.height = 0;
+		s.recording = 0;
+		s.pending = false;
+	}
+
+	writer = std::thread(&frameCapture::writerLoop, this);
+}
+
+frameCapture::~frameCapture()
+{
+	// the writer drains what is queued before pop gives up
+	jobs.close();
+	writer.join();
+
+	for (slot& s : ring)
+	{
+		if (s.fence)
+			glDeleteSync(s.fence);
+		glDeleteBuffers(1, &s.buffer);
+	}
+}
+
+void frameCapture::start(const std::string& prefix, const std::string& extension)
+{
+	framePrefix = prefix;
+	frameExtension = extension;
+	capturedFrames = 0;
+	droppedFrames = 0;
+	{
+		std::lock_guard<std::mutex> guard(countLock);
+		session++;
+		writtenFrames = 0;
+		failedFrames = 0;
+	}
+	active = true;
+}
+
+int frameCapture::written() const
+{
+	std::lock_guard<std::mutex> guard(countLock);
+	return writtenFrames;
+}
+
+int frameCapture::failed() const
+{
+	std::lock_guard<std::mutex> guard(countLock);
+	return failedFrames;
+}
+
+void frameCapture::count(int recording, int& counter)
+{
+	std::lock_guard<std::mutex> guard(countLock);
+	if (recording == session)
+		counter++;
+}
+
+void frameCapture::stop()
+{
+	// readbacks already in flight are still collected by poll()
+	active = false;
+}
+
+void frameCapture::capture(int width, int height)
+{
+	if (!active || width <= 0 || height <= 0)
+		return;
+
+	slot& s = ring[writeIndex];
+	if (s.pending)
+	{
+		// ring is full, reusing the slot now would stall
+		droppedFrames++;
+		return;
+	}
+
+	// RGBA bytes are the layout drivers read back without a conversion pass, and keep rows 4 byte aligned
+	const GLsizeiptr size = static_cast<GLsizeiptr>(width) * height * 4;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, s.buffer);
+	if (s.size != size)
+	{
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+		s.size = size;
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glReadBuffer(GL_BACK);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	// with a pack buffer bound the last argument is an offset into it and the call returns without waiting
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	char index[16];
+	snprintf(index, sizeof(index), "_%05d", capturedFrames);
+	s.path = framePrefix + index + frameExtension;
+	s.width = width;
+	s.height = height;
+	s.recording = session;
+	s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	s.pending = true;
+	writeIndex = (writeIndex + 1) % static_cast<int>(ring.size());
+	capturedFrames++;
+}
+
+void frameCapture::poll()
+{
+	while (ring[readIndex].pending && collect(ring[readIndex], 0))
+		readIndex = (readIndex + 1) % static_cast<int>(ring.size());
+}
+
+void frameCapture::finish()
+{
+	active = false;
+
+	// a second per frame is far more than any readback takes, a lost context must not hang the exit
+	const GLuint64 timeoutNs = 1000000000;
+	while (ring[readIndex].pending && collect(ring[readIndex], timeoutNs))
+		readIndex = (readIndex + 1) % static_cast<int>(ring.size());
+}
+
+bool frameCapture::collect(slot& s, GLuint64 timeout)
+{
+	const GLenum status = glClientWaitSync(s.fence, timeout > 0 ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+	if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		return false;
+
+	glDeleteSync(s.fence);
+	s.fence = nullptr;
+	s.pending = false;
+
+	job j;
+	j.path = s.path;
+	j.recording = s.recording;
+	j.width = s.width;
+	j.height = s.height;
+	j.rgba.resize(static_cast<size_t>(s.size));
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, s.buffer);
+	const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, s.size, GL_MAP_READ_BIT);
+	const bool copied = mapped != nullptr;
+	if (copied)
+		memcpy(j.rgba.data(), mapped, j.rgba.size());
+	if (copied && !glUnmapBuffer(GL_PIXEL_PACK_BUFFER))
+		j.rgba.clear();     // the store was lost while mapped, the copy may be garbage
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	if (!copied || j.rgba.empty())
+		count(s.recording, failedFrames);
+	// the render loop never waits on the writer, only the exit does
+	else if (!(timeout > 0 ? jobs.push(std::move(j)) : jobs.tryPush(j)) && s.recording == session)
+		droppedFrames++;
+	return true;
+}
+
+void frameCapture::writerLoop()
+{
+	job j;
+	while (jobs.pop(j))
+	{
+		// flip to rows top to bottom and drop alpha, the layout the encoders take
+		std::vector<uint8_t> rgb(static_cast<size_t>(j.width) * j.height * 3);
+		for (int y = 0; y < j.height; y++)
+		{
+			const uint8_t* src = j.rgba.data() + static_cast<size_t>(j.height - 1 - y) * j.width * 4;
+			uint8_t* dst = rgb.data() + static_cast<size_t>(y) * j.width * 3;
+			for (int x = 0; x < j.width; x++)
+			{
+				dst[x * 3 + 0] = src[x * 4 + 0];
+				dst[x * 3 + 1] = src[x * 4 + 1];
+				dst[x * 3 + 2] = src[x * 4 + 2];
+			}
+		}
+
+		const bool qoi = j.path.size() >= 4 && j.path.compare(j.path.size() - 4, 4, ".qoi") == 0;
+		if (writeFile(j.path, qoi ? encodeQOI(j.width, j.height, rgb) : encodePNG(j.width, j.height, rgb)))
+			count(j.recording, writtenFrames);
+		else
+			count(j.recording, failedFrames);
+	}
+}
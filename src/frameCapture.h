@@ -0,0 +1,83 @@
+#pragma once
+
+#include "common.h"
+#include "boundedQueue.h"
+
+#include <mutex>
+#include <thread>
+
+// records the window to numbered image files without stalling the render loop
+// glReadPixels lands in a ring of pixel buffer objects behind fences, a slot is only mapped once its fence
+// has signalled a frame or two later, and a writer thread encodes and writes the copies off the render thread
+// when the ring or the writer falls behind, frames are dropped and counted instead of waiting
+class frameCapture
+{
+public:
+	explicit frameCapture(int ringSize = 3, int writerQueue = 8);
+	~frameCapture();
+
+	frameCapture(const frameCapture&) = delete;
+	frameCapture& operator=(const frameCapture&) = delete;
+
+	// frames go to prefix_00000.ext onwards, .qoi or anything else as png
+	// the counts start over, frames of an earlier recording still being written are not counted into them
+	void start(const std::string& prefix, const std::string& extension);
+	void stop();
+	bool recording() const { return active; };
+
+	// reads the bound back buffer of the default framebuffer into the next free slot, call it before the UI is drawn
+	// a zero size framebuffer (minimized window) is skipped
+	void capture(int width, int height);
+	// maps every slot whose fence has signalled and hands the pixels to the writer
+	void poll();
+	// waits for the readbacks still in flight, for the end of the program only
+	void finish();
+
+	int captured() const { return capturedFrames; };
+	int dropped() const { return droppedFrames; };
+	int written() const;
+	int failed() const;
+private:
+	struct slot
+	{
+		GLuint buffer;
+		GLsync fence;
+		GLsizeiptr size;
+		int width;
+		int height;
+		std::string path;
+		int recording;      // session the frame belongs to
+		bool pending;
+	};
+
+	struct job
+	{
+		std::string path;
+		int recording;
+		int width;
+		int height;
+		std::vector<uint8_t> rgba;      // rows bottom to top, as glReadPixels returns them
+	};
+
+	bool collect(slot& s, GLuint64 timeout);
+	void writerLoop();
+	void count(int recording, int& counter);
+
+	std::vector<slot> ring;
+	int writeIndex;
+	int readIndex;
+
+	std::string framePrefix;
+	std::string frameExtension;
+	bool active;
+	int session;            // bumped by every start()
+	int capturedFrames;
+	int droppedFrames;
+
+	boundedQueue<job> jobs;
+	std::thread writer;
+	// shared with the writer thread, only counted while the frame's recording is the current one
+	mutable std::mutex countLock;
+	int writtenFrames;
+	int failedFrames;
+};
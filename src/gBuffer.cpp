@@ -0,0 +1,86 @@
+#include "gBuffer.h"
+
+gBuffer::gBuffer()
+	: geometryShader("shaders/juliaGeometry.comp"), shadeShader("shaders/render.vert", "shaders/shadeGBuffer.frag"),
+	  hitTex(0), normalTex(0), stepsTex(0), width(0), height(0), layers(0), cached(false)
+{
+}
+
+gBuffer::~gBuffer()
+{
+	if (hitTex)
+		glDeleteTextures(1, &hitTex);
+	if (normalTex)
+		glDeleteTextures(1, &normalTex);
+	if (stepsTex)
+		glDeleteTextures(1, &stepsTex);
+}
+
+void gBuffer::allocate(int w, int h, int samples)
+{
+	if (w == width && h == height && samples == layers)
+		return;
+
+	width = w;
+	height = h;
+	layers = samples;
+	cached = false;
+
+	// immutable storage cannot be resized, so start over
+	if (hitTex)
+		glDeleteTextures(1, &hitTex);
+	if (normalTex)
+		glDeleteTextures(1, &normalTex);
+	if (stepsTex)
+		glDeleteTextures(1, &stepsTex);
+
+	// 8 bit normals are plenty for Phong, the distance has to place the hit to well below epsilon
+	// step counts stay far below 65536, MAX_MARCH_STEPS tops out at 2048
+	const GLenum formats[3] = { GL_R32F, GL_RGBA8_SNORM, GL_R16UI };
+	GLuint* textures[3] = { &hitTex, &normalTex, &stepsTex };
+	for (int i = 0; i < 3; i++)
+	{
+		glGenTextures(1, textures[i]);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, *textures[i]);
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, formats[i], width, height, layers);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+bool gBuffer::march(int renderWidth, int renderHeight, int samples, bool reprojected)
+{
+	if (!valid() || samples < 1 || samples > GBUFFER_MAX_SAMPLES)
+		return false;
+
+	allocate(renderWidth, renderHeight, samples);
+	if (cached)
+		return false;
+
+	geometryShader.bindComp();
+	geometryShader.setUniform1i(uniformID::sampleOffset, 0);
+	geometryShader.setUniform1i(uniformID::useReprojection, reprojected);
+	glBindImageTexture(GBUFFER_HIT_UNIT, hitTex, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R32F);
+	glBindImageTexture(GBUFFER_NORMAL_UNIT, normalTex, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8_SNORM);
+	glBindImageTexture(GBUFFER_STEPS_UNIT, stepsTex, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R16UI);
+	geometryShader.dispatchCompute(width, height);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	cached = true;
+	return true;
+}
+
+void gBuffer::shade()
+{
+	if (!cached)
+		return;
+
+	shadeShader.bindVF();
+	glActiveTexture(GL_TEXTURE0 + GBUFFER_HIT_UNIT);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, hitTex);
+	glActiveTexture(GL_TEXTURE0 + GBUFFER_NORMAL_UNIT);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, normalTex);
+	glActiveTexture(GL_TEXTURE0);
+	glDrawArrays(GL_TRIANGLES, 0, 6);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "shader.h"
+
+// units the deferred programs use for the sample layers (gHitDistance and gNormal in juliaGeometry.comp / shadeGBuffer.frag)
+// images for the geometry pass, textures for the shading pass
+static const unsigned int GBUFFER_HIT_UNIT = 4;
+static const unsigned int GBUFFER_NORMAL_UNIT = 5;
+// image unit of the step count layers (gSteps), only the geometry pass writes them so no texture unit is taken
+static const unsigned int GBUFFER_STEPS_UNIT = 6;
+// layers allocated at most, more AA samples than this render through the single pass programs
+static const int GBUFFER_MAX_SAMPLES = 8;
+
+// keeps the hit distance, normal and march step count of every AA sample of the last march
+// the distance stands in for both the hit flag (negative on a miss) and the position, which the shading pass
+// rebuilds along the sample's ray, the step count is there for inspection and tuning, shading never reads it
+// changes that only affect lighting (light, colours, background) reshade the layers without marching again
+class gBuffer
+{
+public:
+	gBuffer();
+	~gBuffer();
+
+	gBuffer(const gBuffer&) = delete;
+	gBuffer& operator=(const gBuffer&) = delete;
+
+	// marches every sample into the layers unless the cached march still matches, returns true if it marched
+	// the juliaParams block must already be uploaded, cone and reprojection start distances bound
+	bool march(int renderWidth, int renderHeight, int samples, bool reprojected);
+
+	// lights the cached samples into the bound framebuffer, colour and hit distance like juliaSet.frag
+	// the full screen quad VAO must be bound
+	void shade();
+
+	// R16UI array of the last march's step counts, one layer per sample
+	GLuint steps() const { return stepsTex; };
+
+	// the cached samples no longer describe the surface (geometry settings, rotation or size changed)
+	void invalidate() { cached = false; };
+	bool cachedGeometry() const { return cached; };
+
+	bool valid() const { return geometryShader.getComp_ID() != 0 && shadeShader.getVF_ID() != 0; };
+private:
+	void allocate(int w, int h, int samples);
+
+	shader geometryShader;
+	shader shadeShader;
+	GLuint hitTex;
+	GLuint normalTex;
+	GLuint stepsTex;
+	int width;
+	int height;
+	int layers;
+	bool cached;
+};
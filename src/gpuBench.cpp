@@ -0,0 +1,306 @@
+// fragment vs compute render path on the GPU, hidden window, no ImGui
+// every case renders the same frame through juliaSet.frag and juliaSet.comp into one float target,
+// times each pass with GL_TIME_ELAPSED and reports median/p95 plus the largest pixel difference
+// between the two images so a faster path cannot silently render something else
+//
+// the cone pre-pass runs inside every timed rep, as it does while the view moves
+// the volume case is the compute path marching through the baked distanceVolume, the bake itself is not timed
+// the specialized cases are both paths built by shaderVariants for the case's iteration and sample counts,
+// against the generic programs that read them from the parameter block, compiling them is not timed either
+//
+// usage: gpuBench [--width N] [--height N] [--aa N] [--cone N] [--reps N] [--out results.json]
+
+#include "common.h"
+#include "shader.h"
+#include "camera.h"
+#include "renderTarget.h"
+#include "gpuTimer.h"
+#include "conePrepass.h"
+#include "temporalCache.h"
+#include "blueNoiseTexture.h"
+#include "marchCounter.h"
+#include "boundingSphere.h"
+#include "distanceVolume.h"
+#include "shaderVariants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+// same constants and iteration counts as the CPU benchmark
+static const glm::vec4 benchConstants[] = {
+    glm::vec4(-0.04f,  0.95f,  0.40f, -0.43f),
+    glm::vec4( 0.15f, -0.85f,  0.50f, -0.20f),
+    glm::vec4(-0.45f,  0.80f,  0.15f,  0.30f),
+    glm::vec4( 0.50f,  0.20f, -0.75f,  0.25f),
+    glm::vec4(-0.60f, -0.20f,  0.80f, -0.10f),
+    glm::vec4( 0.10f, -0.50f,  0.60f,  0.00f),
+};
+static const int benchIterations[] = { 20, 80, 200 };
+
+struct gpuBenchResult
+{
+    std::string path;
+    glm::vec4 constant;
+    int maxIterations;
+    float maxDiff;          // largest channel difference to the fragment path image
+    std::vector<double> ms; // one entry per repetition
+};
+
+static double percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+static std::vector<float> readTarget(const renderTarget& target)
+{
+    std::vector<float> pixels(static_cast<size_t>(target.width()) * target.height() * 4);
+    glBindTexture(GL_TEXTURE_2D, target.texture(0));
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return pixels;
+}
+
+static std::string toJSON(const std::vector<gpuBenchResult>& results, int reps, int width, int height, int aa, int coneBlock)
+{
+    const GLubyte* renderer = glGetString(GL_RENDERER);
+
+    std::ostringstream out;
+    out << "{\n  \"gpu\": \"" << (renderer ? reinterpret_cast<const char*>(renderer) : "unknown") << "\""
+        << ",\n  \"width\": " << width << ",\n  \"height\": " << height << ",\n  \"aaSamples\": " << aa << ",\n  \"coneBlock\": " << coneBlock
+        << ",\n  \"reps\": " << reps << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const gpuBenchResult& r = results[i];
+        const double medianMs = percentile(r.ms, 0.5);
+        const double p95Ms = percentile(r.ms, 0.95);
+
+        out << "    { \"path\": \"" << r.path << "\""
+            << ", \"constant\": [" << r.constant.x << ", " << r.constant.y << ", " << r.constant.z << ", " << r.constant.w << "]"
+            << ", \"maxIterations\": " << r.maxIterations
+            << ", \"median_ms\": " << medianMs
+            << ", \"p95_ms\": " << p95Ms
+            << ", \"median_mpix_per_sec\": " << (medianMs > 0.0 ? width * static_cast<double>(height) / 1000.0 / medianMs : 0.0)
+            << ", \"max_diff\": " << r.maxDiff
+            << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+int main(int argc, char** argv)
+{
+    int width = 1280;
+    int height = 720;
+    int aa = 4;
+    int coneBlock = juliaSettings().coneBlock;
+    int reps = 15;
+    std::string outPath;
+
+    const char* usage = "usage: gpuBench [--width N] [--height N] [--aa N] [--cone N] [--reps N] [--out results.json]";
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (!value)
+        {
+            std::cerr << "missing value for " << arg << std::endl;
+            std::cerr << usage << std::endl;
+            return -1;
+        }
+        i++;
+
+        if (strcmp(arg, "--width") == 0) width = std::max(1, atoi(value));
+        else if (strcmp(arg, "--height") == 0) height = std::max(1, atoi(value));
+        else if (strcmp(arg, "--aa") == 0) aa = std::max(1, atoi(value));
+        else if (strcmp(arg, "--cone") == 0) coneBlock = std::max(0, atoi(value));
+        else if (strcmp(arg, "--reps") == 0) reps = std::max(1, atoi(value));
+        else if (strcmp(arg, "--out") == 0) outPath = value;
+        else
+        {
+            std::cerr << usage << std::endl;
+            return -1;
+        }
+    }
+
+    if (!glfwInit())
+    {
+        std::cerr << "GLFW init failed\n";
+        return -1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "gpuBench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    std::string json;
+    {
+        shader fragShader("shaders/render.vert", "shaders/juliaSet.frag");
+        shader compShader("shaders/juliaSet.comp");
+        if (!fragShader.getVF_ID() || !compShader.getComp_ID())
+        {
+            std::cerr << "failed to build the render programs" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+
+        camera cam(static_cast<float>(width), static_cast<float>(height));
+        juliaParams params;
+        conePrepass cone;
+        blueNoiseTexture sampleNoise;
+        sampleNoise.bind();
+        // binds a buffer for the exhausted ray count, nothing here reads it
+        marchCounter exhaustedCounter;
+        // both paths march inside the same measured sphere the viewer uses
+        threadPool boundsPool;
+        distanceVolume volume;
+        renderTarget target({ GL_RGBA32F, GL_R32F });
+        target.resize(width, height);
+
+        float quadVerts[] = { -1, -1, 1, -1, 1, 1, -1, -1, 1, 1, -1, 1 };
+        GLuint quadVAO, quadVBO;
+        glGenVertexArrays(1, &quadVAO);
+        glGenBuffers(1, &quadVBO);
+        glBindVertexArray(quadVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVerts), quadVerts, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+        auto renderCone = [&]
+        {
+            if (coneBlock > 0)
+            {
+                cone.update(width, height, coneBlock, true);
+                cone.bind();
+            }
+        };
+        auto renderFragment = [&](const shader& program)
+        {
+            renderCone();
+            target.bind();
+            program.bindVF();
+            program.setUniform1i(uniformID::sampleOffset, 0);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+        };
+        auto renderCompute = [&](const shader& program)
+        {
+            renderCone();
+            program.bindComp();
+            program.setUniform1i(uniformID::sampleOffset, 0);
+            glBindImageTexture(0, target.texture(0), 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+            glBindImageTexture(HIT_DEPTH_IMAGE_UNIT, target.texture(1), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+            program.dispatchCompute(width, height);
+            glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        };
+
+        std::vector<gpuBenchResult> results;
+        for (const glm::vec4& c : benchConstants)
+        {
+            for (int iterations : benchIterations)
+            {
+                juliaSettings set;
+                set.juliaConstant = c;
+                set.maxIterations = iterations;
+                set.aaSamples = aa;
+                set.coneBlock = coneBlock;
+                params.setSettings(set);
+                params.setBoundingRadius(tightBoundingRadius(set, boundsPool, height));
+                params.setCamera(cam);
+                params.upload();
+                const bool baked = volume.bake(params.data().boundingRadius);
+                const shader fragVariant("shaders/render.vert", "shaders/juliaSet.frag", variantDefines(params.data()));
+                const shader compVariant("shaders/juliaSet.comp", variantDefines(params.data()));
+
+                std::vector<float> reference;
+                for (const char* path : { "fragment", "compute", "volume", "fragment-specialized", "compute-specialized" })
+                {
+                    const bool useVolume = strcmp(path, "volume") == 0;
+                    if (useVolume && !baked)
+                        continue;
+                    const bool specialized = strstr(path, "-specialized") != nullptr;
+                    const bool compute = useVolume || strncmp(path, "compute", 7) == 0;
+                    const shader& program = compute ? (specialized ? compVariant : compShader) : (specialized ? fragVariant : fragShader);
+                    if (compute ? !program.getComp_ID() : !program.getVF_ID())
+                        continue;
+                    params.setVolume(useVolume, volume.radius());
+                    params.upload();
+                    gpuBenchResult r = { path, c, iterations, 0.0f, {} };
+
+                    // one warm-up frame, then every rep gets its own query so nothing waits in between
+                    compute ? renderCompute(program) : renderFragment(program);
+                    gpuTimer timer(reps + 1);
+                    for (int rep = 0; rep < reps; rep++)
+                    {
+                        timer.begin(rep);
+                        compute ? renderCompute(program) : renderFragment(program);
+                        timer.end();
+                    }
+                    glFinish();
+
+                    long long tag = 0;
+                    float ms = 0.0f;
+                    while (timer.poll(tag, ms))
+                        r.ms.push_back(ms);
+
+                    std::vector<float> pixels = readTarget(target);
+                    if (reference.empty())
+                        reference = pixels;
+                    for (size_t i = 0; i < pixels.size(); i++)
+                        r.maxDiff = std::max(r.maxDiff, std::fabs(pixels[i] - reference[i]));
+
+                    results.push_back(r);
+                }
+
+                std::cerr << "constant (" << c.x << ", " << c.y << ", " << c.z << ", " << c.w << ") iterations " << iterations << " done" << std::endl;
+            }
+        }
+
+        json = toJSON(results, reps, width, height, aa, coneBlock);
+
+        glDeleteBuffers(1, &quadVBO);
+        glDeleteVertexArrays(1, &quadVAO);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    if (outPath.empty())
+    {
+        std::cout << json;
+    }
+    else
+    {
+        std::ofstream file(outPath);
+        if (!file)
+        {
+            std::cerr << "failed to open " << outPath << std::endl;
+            return -1;
+        }
+        file << json;
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include "gpuTimer.h"
+
+#include <algorithm>
+
+gpuTimer::gpuTimer(int ringSize)
+	: ring(std::max(ringSize, 2)), writeIndex(0), readIndex(0), active(false), latestMs(0.0f)
+{
+	for (slot& s : ring)
+	{
+		glGenQueries(1, &s.query);
+		s.tag = 0;
+		s.pending = false;
+	}
+}
+
+gpuTimer::~gpuTimer()
+{
+	for (slot& s : ring)
+		glDeleteQueries(1, &s.query);
+}
+
+void gpuTimer::begin(long long tag)
+{
+	slot& s = ring[writeIndex];
+	if (s.pending)
+		return;     // ring is full, reading now would stall
+
+	s.tag = tag;
+	glBeginQuery(GL_TIME_ELAPSED, s.query);
+	active = true;
+}
+
+void gpuTimer::end()
+{
+	if (!active)
+		return;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	ring[writeIndex].pending = true;
+	writeIndex = (writeIndex + 1) % static_cast<int>(ring.size());
+	active = false;
+}
+
+bool gpuTimer::poll(long long& tag, float& ms)
+{
+	slot& s = ring[readIndex];
+	if (!s.pending)
+		return false;
+
+	int available = 0;
+	glGetQueryObjectiv(s.query, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return false;
+
+	GLuint64 elapsedNs = 0;
+	glGetQueryObjectui64v(s.query, GL_QUERY_RESULT, &elapsedNs);
+
+	s.pending = false;
+	readIndex = (readIndex + 1) % static_cast<int>(ring.size());
+
+	tag = s.tag;
+	ms = static_cast<float>(elapsedNs / 1.0e6);
+	latestMs = ms;
+	return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common.h"
+
+// GL_TIME_ELAPSED around one pass, read back a few frames later from a ring of query objects
+// so the CPU never waits for the GPU to catch up
+class gpuTimer
+{
+public:
+	explicit gpuTimer(int ringSize = 4);
+	~gpuTimer();
+
+	gpuTimer(const gpuTimer&) = delete;
+	gpuTimer& operator=(const gpuTimer&) = delete;
+
+	// tag identifies the frame the measurement belongs to, it comes back out of poll()
+	// if every query in the ring is still in flight the pass is not measured
+	void begin(long long tag);
+	void end();
+
+	// collects the oldest finished query, returns false if none are ready yet
+	bool poll(long long& tag, float& ms);
+
+	float lastMs() const { return latestMs; };
+private:
+	struct slot
+	{
+		unsigned int query;
+		long long tag;
+		bool pending;
+	};
+
+	std::vector<slot> ring;
+	int writeIndex;
+	int readIndex;
+	bool active;
+	float latestMs;
+};
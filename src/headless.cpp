@@ -0,0 +1,246 @@
+// offline renderer, no window, no GL context and no ImGui
+// renders juliaSet.frag through cpuRenderer and writes the result as png or pfm
+//
+// usage: headless [options] --out image.png
+//   --width N --height N        output resolution (1280x720)
+//   --aa N                      samples per pixel
+//   --aa-max N                  adaptive budget per pixel, rounds of --aa samples until a pixel settles
+//   --aa-threshold T            standard error at which an adaptive pixel settles
+//   --pattern hash|r2|sobol     where the samples land inside a pixel
+//   --iterations N              max quaternion iterations
+//   --epsilon E                 hit threshold, or the pixel footprint multiple with --epsilon-mode footprint
+//   --epsilon-mode absolute|footprint
+//   --max-steps N               march steps per ray before it is given up as a miss
+//   --relaxation W              over-relaxed step factor, 1 = plain sphere tracing
+//   --bounds tight|loose        march inside the measured bounding sphere or the fixed radius 2 one
+//   --c w,i,j,k                 julia constant
+//   --fov DEG
+//   --yaw RAD --pitch RAD       same rotation the WASD keys drive
+//   --threads N                 0 = all cores
+//   --isa scalar|sse4|avx2|avx512
+//   --normals analytic|tetrahedral|central
+//   --cone N                    pixel block of the cone pre-pass, 0 = off
+//   --frames N                  render N times, the last frame is written
+
+#include "cpuRenderer.h"
+#include "imageWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static void printUsage()
+{
+    std::cout << "usage: headless [--width N] [--height N] [--aa N] [--aa-max N] [--aa-threshold T] [--pattern hash|r2|sobol] [--iterations N] [--epsilon E]\n"
+                 "                [--epsilon-mode absolute|footprint] [--max-steps N] [--relaxation W] [--bounds tight|loose]\n"
+                 "                [--c w,i,j,k] [--fov DEG] [--yaw RAD] [--pitch RAD]\n"
+                 "                [--threads N] [--isa scalar|sse4|avx2|avx512] [--normals analytic|tetrahedral|central]\n"
+                 "                [--cone N] [--frames N] --out FILE.png|FILE.pfm\n";
+}
+
+static bool parseISA(const char* name, simdISA& isa)
+{
+    for (simdISA candidate : { simdISA::scalar, simdISA::sse4, simdISA::avx2, simdISA::avx512 })
+    {
+        if (strcmp(name, isaName(candidate)) == 0)
+        {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseNormals(const char* name, int& normalMode)
+{
+    for (int i = 0; i < static_cast<int>(normalMethod::count); i++)
+    {
+        if (strcmp(name, normalMethodNames[i]) == 0)
+        {
+            normalMode = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parseEpsilonMode(const char* name, int& epsilonMode)
+{
+    for (int i = 0; i < static_cast<int>(epsilonMethod::count); i++)
+    {
+        if (strcmp(name, epsilonMethodNames[i]) == 0)
+        {
+            epsilonMode = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool parsePattern(const char* name, int& pattern)
+{
+    for (int i = 0; i < static_cast<int>(sampleSequence::count); i++)
+    {
+        if (strcmp(name, sampleSequenceNames[i]) == 0)
+        {
+            pattern = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    int width = 1280;
+    int height = 720;
+    int threads = 0;
+    int frames = 1;
+    float yaw = 0.0f;
+    float pitch = 0.0f;
+    simdISA isa = detectISA();
+    std::string outPath;
+    bool tightBounds = true;
+    juliaSettings settings;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+        {
+            printUsage();
+            return 0;
+        }
+        if (!value)
+        {
+            std::cerr << "missing value for " << arg << std::endl;
+            printUsage();
+            return -1;
+        }
+        i++;
+
+        if (strcmp(arg, "--width") == 0) width = atoi(value);
+        else if (strcmp(arg, "--height") == 0) height = atoi(value);
+        else if (strcmp(arg, "--aa") == 0) settings.aaSamples = atoi(value);
+        else if (strcmp(arg, "--max-steps") == 0) settings.maxMarchSteps = atoi(value);
+        else if (strcmp(arg, "--relaxation") == 0) settings.relaxation = static_cast<float>(atof(value));
+        else if (strcmp(arg, "--aa-max") == 0) settings.maxAASamples = atoi(value);
+        else if (strcmp(arg, "--aa-threshold") == 0) settings.aaThreshold = static_cast<float>(atof(value));
+        else if (strcmp(arg, "--iterations") == 0) settings.maxIterations = atoi(value);
+        else if (strcmp(arg, "--epsilon") == 0) settings.epsilon = static_cast<float>(atof(value));
+        else if (strcmp(arg, "--fov") == 0) settings.fov = static_cast<float>(atof(value));
+        else if (strcmp(arg, "--yaw") == 0) yaw = static_cast<float>(atof(value));
+        else if (strcmp(arg, "--pitch") == 0) pitch = static_cast<float>(atof(value));
+        else if (strcmp(arg, "--cone") == 0) settings.coneBlock = std::max(0, atoi(value));
+        else if (strcmp(arg, "--threads") == 0) threads = std::max(0, atoi(value));
+        else if (strcmp(arg, "--frames") == 0) frames = atoi(value);
+        else if (strcmp(arg, "--out") == 0) outPath = value;
+        else if (strcmp(arg, "--c") == 0)
+        {
+            glm::vec4& c = settings.juliaConstant;
+            if (sscanf(value, "%f,%f,%f,%f", &c.x, &c.y, &c.z, &c.w) != 4)
+            {
+                std::cerr << "--c expects w,i,j,k" << std::endl;
+                return -1;
+            }
+        }
+        else if (strcmp(arg, "--bounds") == 0)
+        {
+            if (strcmp(value, "tight") == 0) tightBounds = true;
+            else if (strcmp(value, "loose") == 0) tightBounds = false;
+            else
+            {
+                std::cerr << "--bounds expects tight or loose" << std::endl;
+                return -1;
+            }
+        }
+        else if (strcmp(arg, "--isa") == 0)
+        {
+            if (!parseISA(value, isa))
+            {
+                std::cerr << "unknown isa " << value << std::endl;
+                return -1;
+            }
+        }
+        else if (strcmp(arg, "--normals") == 0)
+        {
+            if (!parseNormals(value, settings.normalMode))
+            {
+                std::cerr << "unknown normal method " << value << std::endl;
+                return -1;
+            }
+        }
+        else if (strcmp(arg, "--epsilon-mode") == 0)
+        {
+            if (!parseEpsilonMode(value, settings.epsilonMode))
+            {
+                std::cerr << "unknown epsilon mode " << value << std::endl;
+                return -1;
+            }
+        }
+        else if (strcmp(arg, "--pattern") == 0)
+        {
+            if (!parsePattern(value, settings.samplePattern))
+            {
+                std::cerr << "unknown sample pattern " << value << std::endl;
+                return -1;
+            }
+        }
+        else
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            printUsage();
+            return -1;
+        }
+    }
+
+    if (outPath.empty() || width <= 0 || height <= 0 || frames <= 0)
+    {
+        printUsage();
+        return -1;
+    }
+
+    camera cam(static_cast<float>(width), static_cast<float>(height));
+    cam.yaw = yaw;
+    cam.pitch = pitch;
+
+    if (isa > detectISA())
+    {
+        std::cerr << isaName(isa) << " is not supported on this cpu, using " << isaName(detectISA()) << std::endl;
+        isa = detectISA();
+    }
+
+    cpuRenderer renderer(static_cast<unsigned>(threads));
+    renderer.isa = isa;
+    renderer.tightBounds = tightBounds;
+
+    std::cout << "rendering " << width << "x" << height << " on " << renderer.threadCount()
+              << " threads (" << isaName(renderer.isa) << ")" << std::endl;
+
+    std::vector<glm::vec3> pixels;
+    for (int f = 0; f < frames; f++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        renderer.render(settings, cam, pixels);
+        auto end = std::chrono::steady_clock::now();
+
+        const renderStats& stats = renderer.stats();
+        std::cout << "frame " << f << ": " << std::chrono::duration<double, std::milli>(end - start).count() << " ms, "
+                  << stats.samplesPerPixel << " samples/pixel, " << stats.evaluationsPerRay << " evaluations/ray, "
+                  << stats.exhaustedRays << " rays exhausted, bounding radius " << stats.boundingRadius << std::endl;
+    }
+
+    if (!writeImage(outPath, width, height, pixels))
+    {
+        std::cerr << "failed to write " << outPath << std::endl;
+        return -1;
+    }
+    std::cout << "wrote " << outPath << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,258 @@
+#include "imageWriter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+
+static uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0)
+{
+    // built once, static init is thread safe so background writers can share it
+    static const std::vector<uint32_t> table = []
+    {
+        std::vector<uint32_t> t(256);
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[n] = c;
+        }
+        return t;
+    }();
+
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void appendBE32(std::vector<uint8_t>& out, uint32_t v)
+{
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static void appendChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+{
+    appendBE32(out, static_cast<uint32_t>(data.size()));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    appendBE32(out, crc32(out.data() + start, out.size() - start));
+}
+
+static uint8_t quantize(float v)
+{
+    return static_cast<uint8_t>(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+std::vector<uint8_t> quantizeRGB8(int width, int height, const std::vector<glm::vec3>& pixels)
+{
+    std::vector<uint8_t> rgb(static_cast<size_t>(width) * height * 3);
+    for (int y = 0; y < height; y++)
+    {
+        uint8_t* row = &rgb[static_cast<size_t>(width) * 3 * y];
+        const glm::vec3* src = &pixels[static_cast<size_t>(height - 1 - y) * width];
+        for (int x = 0; x < width; x++)
+        {
+            row[x * 3 + 0] = quantize(src[x].x);
+            row[x * 3 + 1] = quantize(src[x].y);
+            row[x * 3 + 2] = quantize(src[x].z);
+        }
+    }
+    return rgb;
+}
+
+std::vector<uint8_t> encodePNG(int width, int height, const std::vector<uint8_t>& rgb)
+{
+    // scanlines each prefixed with filter type 0
+    const size_t rowBytes = static_cast<size_t>(width) * 3 + 1;
+    std::vector<uint8_t> raw(rowBytes * height);
+    for (int y = 0; y < height; y++)
+    {
+        uint8_t* row = &raw[rowBytes * y];
+        row[0] = 0;
+        std::copy_n(&rgb[(rowBytes - 1) * y], rowBytes - 1, row + 1);
+    }
+
+    // zlib stream made of stored deflate blocks, no compression library needed
+    std::vector<uint8_t> zlib = { 0x78, 0x01 };
+    uint32_t a = 1, b = 0;
+    size_t offset = 0;
+    while (true)
+    {
+        size_t blockLen = std::min<size_t>(raw.size() - offset, 65535);
+        bool last = offset + blockLen >= raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(blockLen));
+        zlib.push_back(static_cast<uint8_t>(blockLen >> 8));
+        zlib.push_back(static_cast<uint8_t>(~blockLen));
+        zlib.push_back(static_cast<uint8_t>(~blockLen >> 8));
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockLen);
+
+        for (size_t i = offset; i < offset + blockLen; i++)
+        {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+
+        offset += blockLen;
+        if (last)
+            break;
+    }
+    appendBE32(zlib, (b << 16) | a);
+
+    std::vector<uint8_t> header;
+    appendBE32(header, static_cast<uint32_t>(width));
+    appendBE32(header, static_cast<uint32_t>(height));
+    header.push_back(8);    // bit depth
+    header.push_back(2);    // truecolor
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+
+    std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    appendChunk(png, "IHDR", header);
+    appendChunk(png, "IDAT", zlib);
+    appendChunk(png, "IEND", std::vector<uint8_t>());
+    return png;
+}
+
+std::vector<uint8_t> encodeQOI(int width, int height, const std::vector<uint8_t>& rgb)
+{
+    // header, then one op per run of pixels: a run of the previous pixel, an index into the 64 most recent,
+    // a small or medium difference to the previous pixel, or the literal value
+    std::vector<uint8_t> qoi = { 'q', 'o', 'i', 'f' };
+    appendBE32(qoi, static_cast<uint32_t>(width));
+    appendBE32(qoi, static_cast<uint32_t>(height));
+    qoi.push_back(3);   // RGB
+    qoi.push_back(0);   // sRGB with linear alpha, the same values writePNG stores
+    qoi.reserve(qoi.size() + rgb.size() + 8);
+
+    // packed RGBA, starts out as transparent black like the decoder's table so no opaque pixel matches it by accident
+    uint32_t seen[64] = {};
+    uint8_t prev[3] = { 0, 0, 0 };
+    int run = 0;
+    const size_t count = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t* px = &rgb[i * 3];
+        if (px[0] == prev[0] && px[1] == prev[1] && px[2] == prev[2])
+        {
+            run++;
+            if (run == 62 || i + 1 == count)
+            {
+                qoi.push_back(static_cast<uint8_t>(0xC0 | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0)
+        {
+            qoi.push_back(static_cast<uint8_t>(0xC0 | (run - 1)));
+            run = 0;
+        }
+
+        // alpha is always 255
+        const uint32_t packed = static_cast<uint32_t>(px[0]) << 24 | static_cast<uint32_t>(px[1]) << 16 | static_cast<uint32_t>(px[2]) << 8 | 0xFFu;
+        const int hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + 255 * 11) % 64;
+        if (seen[hash] == packed)
+        {
+            qoi.push_back(static_cast<uint8_t>(hash));
+        }
+        else
+        {
+            seen[hash] = packed;
+
+            const int dr = static_cast<int8_t>(px[0] - prev[0]);
+            const int dg = static_cast<int8_t>(px[1] - prev[1]);
+            const int db = static_cast<int8_t>(px[2] - prev[2]);
+            const int drdg = dr - dg;
+            const int dbdg = db - dg;
+            if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+            {
+                qoi.push_back(static_cast<uint8_t>(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+            }
+            else if (dg >= -32 && dg <= 31 && drdg >= -8 && drdg <= 7 && dbdg >= -8 && dbdg <= 7)
+            {
+                qoi.push_back(static_cast<uint8_t>(0x80 | (dg + 32)));
+                qoi.push_back(static_cast<uint8_t>((drdg + 8) << 4 | (dbdg + 8)));
+            }
+            else
+            {
+                qoi.push_back(0xFE);
+                qoi.insert(qoi.end(), px, px + 3);
+            }
+        }
+
+        prev[0] = px[0];
+        prev[1] = px[1];
+        prev[2] = px[2];
+    }
+
+    const uint8_t end[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    qoi.insert(qoi.end(), end, end + 8);
+    return qoi;
+}
+
+bool writeFile(const std::string& path, const std::vector<uint8_t>& bytes)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return file.good();
+}
+
+bool writePNG(const std::string& path, int width, int height, const std::vector<glm::vec3>& pixels)
+{
+    if (width <= 0 || height <= 0 || pixels.size() < static_cast<size_t>(width) * height)
+        return false;
+    return writeFile(path, encodePNG(width, height, quantizeRGB8(width, height, pixels)));
+}
+
+bool writeQOI(const std::string& path, int width, int height, const std::vector<glm::vec3>& pixels)
+{
+    if (width <= 0 || height <= 0 || pixels.size() < static_cast<size_t>(width) * height)
+        return false;
+    return writeFile(path, encodeQOI(width, height, quantizeRGB8(width, height, pixels)));
+}
+
+bool writePFM(const std::string& path, int width, int height, const std::vector<glm::vec3>& pixels)
+{
+    if (width <= 0 || height <= 0 || pixels.size() < static_cast<size_t>(width) * height)
+        return false;
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    // negative scale marks little endian, rows are stored bottom to top like ours
+    const uint16_t probe = 1;
+    const bool littleEndian = *reinterpret_cast<const uint8_t*>(&probe) == 1;
+    file << "PF\n" << width << " " << height << "\n" << (littleEndian ? "-1.0" : "1.0") << "\n";
+    file.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(sizeof(glm::vec3)) * width * height);
+    return file.good();
+}
+
+bool writeImage(const std::string& path, int width, int height, const std::vector<glm::vec3>& pixels)
+{
+    std::string ext = path.size() >= 4 ? path.substr(path.size() - 4) : std::string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (ext == ".pfm")
+        return writePFM(path, width, height, pixels);
+    if (ext == ".qoi")
+        return writeQOI(path, width, height, pixels);
+    return writePNG(path, width, height, pixels);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// pixels are linear floats, row 0 is the bottom row (glReadPixels / cpuRenderer order)
+
+// 8 bit RGB, values are clamped to [0, 1] the same way the default framebuffer does
+bool writePNG(const std::string& path, int width, int height, const std::vector<glm::vec3>& pixels);
+// same 8 bit RGB as QOI, far smaller than our uncompressed PNG and about as cheap to encode
+bool writeQOI(const std::string& path, int width, int height, const std::vector<glm::vec3>& pixels);
+// 32 bit float RGB, unclamped
+bool writePFM(const std::string& path, int width, int height, const std::vector<glm::vec3>& pixels);
+
+// picks the format from the file extension, .pfm, .qoi or anything else as png
+bool writeImage(const std::string& path, int width, int height, const std::vector<glm::vec3>& pixels);
+
+// the steps of writePNG / writeQOI on their own, so a pipeline can run each on its own thread
+// quantizeRGB8 clamps like writePNG and flips to rows top to bottom, the layout both encoders take
+std::vector<uint8_t> quantizeRGB8(int width, int height, const std::vector<glm::vec3>& pixels);
+std::vector<uint8_t> encodePNG(int width, int height, const std::vector<uint8_t>& rgb);
+std::vector<uint8_t> encodeQOI(int width, int height, const std::vector<uint8_t>& rgb);
+bool writeFile(const std::string& path, const std::vector<uint8_t>& bytes);
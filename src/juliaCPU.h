@@ -0,0 +1,397 @@
+#pragma once
+
+#include "juliaSettings.h"
+
+#include <algorithm>
+#include <cmath>
+
+// C++ port of the raymarching helpers in shaders/juliaSet.frag
+// keep these in step with the shader so both renderers produce the same image
+
+static const float ESCAPE_THRESHOLD = 1e1f;
+
+struct Ray
+{
+	glm::vec3 dir;
+	glm::vec3 origin;
+};
+
+// per-frame state the shader reads from uniforms
+struct juliaFrame
+{
+	juliaSettings set;
+	glm::mat3 rotation = glm::mat3(1.0f);
+	glm::vec3 camPos = glm::vec3(0.0f);
+	float pixelAngle = 0.0f;    // angle one pixel subtends, only read by epsilonMethod::footprint
+	float boundingRadius = BOUNDING_SPHERE_RADIUS;  // tightBoundingRadius of set once known
+};
+
+inline glm::vec3 quartImag(const glm::vec4& q)
+{
+	return glm::vec3(q.y, q.z, q.w);
+}
+
+inline glm::vec4 quartMult(const glm::vec4& q1, const glm::vec4& q2)
+{
+	glm::vec3 v1 = quartImag(q1);
+	glm::vec3 v2 = quartImag(q2);
+	glm::vec3 v = q1.x * v2 + q2.x * v1 + glm::cross(v1, v2);
+	return glm::vec4(q1.x * q2.x - glm::dot(v1, v2), v.x, v.y, v.z);
+}
+
+inline glm::vec4 quartSquared(const glm::vec4& q)
+{
+	glm::vec3 v = quartImag(q);
+	glm::vec3 a = 2.0f * q.x * v;
+	return glm::vec4(q.x * q.x - glm::dot(v, v), a.x, a.y, a.z);
+}
+
+// to move the ray onto the sphere bounding the julia set before starting raymarching
+inline float intersectBoundingSphere(const glm::vec3& r0, const glm::vec3& rd, float radius = BOUNDING_SPHERE_RADIUS)
+{
+	float B = 2.0f * glm::dot(r0, rd);
+	float C = glm::dot(r0, r0) - radius * radius;
+
+	float disc = B * B - 4.0f * C;
+	if (disc < 0.0f) return -1.0f;
+
+	float s = std::sqrt(disc);
+	float t0 = (-B - s) * 0.5f;
+	float t1 = (-B + s) * 0.5f;
+
+	float t = (t0 > 0.0f) ? t0 : t1;
+	if (t < 0.0f) return -1.0f;
+
+	return t;
+}
+
+inline void iterateIntersect(glm::vec4& q, glm::vec4& qp, const glm::vec4& juliaConstant, int maxSteps)
+{
+	for (int i = 0; i < maxSteps; i++)
+	{
+		qp = 2.0f * quartMult(q, qp);
+		q = quartSquared(q) + juliaConstant;
+
+		if (juliaConstant == glm::vec4(0.01f))
+		{
+			q += glm::vec4(1.0f);
+		}
+
+		if (glm::dot(q, q) > ESCAPE_THRESHOLD)
+		{
+			break;
+		}
+	}
+}
+
+// lower bound on the distance from p to the julia set, no marching
+inline float distanceBound(const juliaFrame& f, const glm::vec3& p)
+{
+	glm::vec4 z = glm::vec4(f.rotation * p, 0.0f);
+	glm::vec4 zp = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+
+	iterateIntersect(z, zp, f.set.juliaConstant, f.set.maxIterations);
+
+	float normZ = glm::length(z);
+	float d = std::max(glm::length(zp), 1e-6f);
+	return 0.5f * normZ * std::log(normZ) / d;
+}
+
+// angle one pixel subtends, widest at the image centre
+inline float pixelAngle(float focal, float resolutionY)
+{
+	return 2.0f / (resolutionY * focal);
+}
+
+// hit threshold of a ray that has travelled t from the camera
+inline float hitEpsilon(const juliaFrame& f, float t)
+{
+	if (f.set.epsilonMode == static_cast<int>(epsilonMethod::footprint))
+		return f.set.epsilon * f.pixelAngle * t;
+	return f.set.epsilon;
+}
+
+// one ray of an over-relaxed sphere trace, the state distanceEstimate keeps between steps
+// the batched march in cpuRenderer keeps one per ray
+struct marchState
+{
+	float t;            // distance travelled from the camera, only kept up for epsilonMethod::footprint
+	float omega;        // current step factor, drops to 1 the first time a relaxed step overshoots
+	float prevDist;
+	float stepLength;
+	int steps;
+};
+
+inline marchState beginMarch(const juliaFrame& f, const Ray& r)
+{
+	marchState m;
+	m.t = f.set.epsilonMode == static_cast<int>(epsilonMethod::footprint) ? glm::length(r.origin - f.camPos) : 0.0f;
+	m.omega = std::max(f.set.relaxation, 1.0f);
+	m.prevDist = 0.0f;
+	m.stepLength = 0.0f;
+	m.steps = 0;
+	return m;
+}
+
+// result of feeding one distance bound into marchStep
+enum class marchResult
+{
+	running,
+	hit,
+	left,       // left the bounding sphere
+	exhausted   // spent maxMarchSteps
+};
+
+// advances r by the bound dist evaluated at r.origin, hitEps gets the threshold the step was tested against
+// same order of tests as distanceEstimate in juliaCommon.glsl
+inline marchResult marchStep(const juliaFrame& f, Ray& r, marchState& m, float dist, float& hitEps)
+{
+	const float bound = f.boundingRadius * f.boundingRadius;
+	hitEps = hitEpsilon(f, m.t);
+	m.steps++;
+
+	// the relaxed step may have skipped the surface, go back to where a plain step would have landed
+	if (m.omega > 1.0f && dist + m.prevDist < m.stepLength)
+	{
+		r.origin -= r.dir * (m.stepLength - m.prevDist);
+		m.t -= m.stepLength - m.prevDist;
+		m.omega = 1.0f;
+	}
+	else if (dist < hitEps)
+	{
+		r.origin += r.dir * dist;
+		return marchResult::hit;
+	}
+	// a relaxed step out of the sphere only counts once the evaluation above has confirmed it
+	else if (glm::dot(r.origin, r.origin) > bound && glm::dot(r.origin, r.dir) > 0.0f)
+	{
+		return marchResult::left;
+	}
+	else
+	{
+		m.stepLength = dist * m.omega;
+		m.prevDist = dist;
+		r.origin += r.dir * m.stepLength;
+		m.t += m.stepLength;
+
+		if (m.omega == 1.0f && glm::dot(r.origin, r.origin) > bound)
+			return marchResult::left;
+	}
+
+	return m.steps >= f.set.maxMarchSteps ? marchResult::exhausted : marchResult::running;
+}
+
+// given a point, get the distance to julia set
+// over-relaxed sphere tracing: steps are set.relaxation times the bound, which holds as long as the unbounding
+// spheres of consecutive steps overlap, and the ray falls back to plain steps the first time they do not
+// hitEps is the threshold the last step was tested against, the ray hit when the returned distance is below it
+// hitEps is negative when the ray spent maxMarchSteps without hitting or leaving the bounding sphere
+inline float distanceEstimate(const juliaFrame& f, Ray& r, float& hitEps)
+{
+	marchState m = beginMarch(f, r);
+	float dist = 0.0f;
+
+	for (int i = 0; i < f.set.maxMarchSteps; i++)
+	{
+		dist = distanceBound(f, r.origin);
+		const marchResult result = marchStep(f, r, m, dist, hitEps);
+		if (result == marchResult::hit || result == marchResult::left)
+			return dist;
+	}
+
+	hitEps = -1.0f;
+	return dist;
+}
+
+inline float distanceEstimate(const juliaFrame& f, Ray& r)
+{
+	float hitEps;
+	return distanceEstimate(f, r, hitEps);
+}
+
+static const int CONE_MAX_STEPS = 128;
+
+// radius per unit distance of a cone around a block centre ray that holds every jittered sample ray of the block
+inline float coneSlope(int coneBlock, float focal, float resolutionY)
+{
+	return 1.1f * std::sqrt(2.0f) * (0.5f * float(coneBlock) + 0.5f) * pixelAngle(focal, resolutionY);
+}
+
+// distance along dir up to which no ray inside the cone can meet the set, -1 if none of them ever does
+inline float coneStartDistance(const juliaFrame& f, const glm::vec3& origin, const glm::vec3& dir, float slope)
+{
+	// start on a sphere padded by the widest cone radius so no ray in the cone enters the real one earlier
+	float padded = f.boundingRadius + slope * (glm::length(origin) + f.boundingRadius);
+	float B = glm::dot(origin, dir);
+	float C = glm::dot(origin, origin) - padded * padded;
+	float disc = B * B - C;
+	if (disc < 0.0f) return -1.0f;
+
+	float t = std::max(-B - std::sqrt(disc), 0.0f);
+	for (int i = 0; i < CONE_MAX_STEPS; i++)
+	{
+		glm::vec3 p = origin + dir * t;
+		float r = slope * t;
+
+		// the whole cross section left the bounding sphere on the far side
+		float outside = f.boundingRadius + r;
+		if (glm::dot(p, p) > outside * outside && glm::dot(p, dir) > 0.0f)
+			return -1.0f;
+
+		// cross section reached the surface, stop while t is still covered
+		float d = distanceBound(f, p);
+		if (d < 2.0f * r)
+			break;
+
+		// furthest t' whose cross section (radius slope * t') still fits in the sphere of radius d at t
+		t = (t + d) / (1.0f + slope);
+	}
+
+	return t;
+}
+
+inline float deAt(const juliaFrame& f, const glm::vec3& p)
+{
+	Ray r;
+	r.origin = p;
+	r.dir = glm::vec3(1.0f, 0.0f, 0.0f);
+	return distanceEstimate(f, r);
+}
+
+inline glm::vec3 estimateNorm(const juliaFrame& f, const glm::vec3& p)
+{
+	const float e = 0.001f;
+
+	float dx = deAt(f, p + glm::vec3(e, 0, 0)) - deAt(f, p - glm::vec3(e, 0, 0));
+	float dy = deAt(f, p + glm::vec3(0, e, 0)) - deAt(f, p - glm::vec3(0, e, 0));
+	float dz = deAt(f, p + glm::vec3(0, 0, e)) - deAt(f, p - glm::vec3(0, 0, e));
+
+	return glm::normalize(glm::vec3(dx, dy, dz));
+}
+
+// d(z^2) applied to the tangent v, the cross terms of z*v + v*z cancel
+inline glm::vec4 jacobianStep(const glm::vec4& z, const glm::vec4& v)
+{
+	glm::vec3 a = z.x * quartImag(v) + v.x * quartImag(z);
+	return 2.0f * glm::vec4(z.x * v.x - glm::dot(quartImag(z), quartImag(v)), a.x, a.y, a.z);
+}
+
+// gradient of |z_n|^2 with respect to p, the columns of dz/dp ride along with the iteration
+// they start as the columns of rotation since z_0 = rotation * p
+inline glm::vec3 analyticNorm(const juliaFrame& f, const glm::vec3& p)
+{
+	glm::vec4 z = glm::vec4(f.rotation * p, 0.0f);
+	glm::vec4 J0 = glm::vec4(f.rotation[0], 0.0f);
+	glm::vec4 J1 = glm::vec4(f.rotation[1], 0.0f);
+	glm::vec4 J2 = glm::vec4(f.rotation[2], 0.0f);
+
+	for (int i = 0; i < f.set.maxIterations; i++)
+	{
+		J0 = jacobianStep(z, J0);
+		J1 = jacobianStep(z, J1);
+		J2 = jacobianStep(z, J2);
+		z = quartSquared(z) + f.set.juliaConstant;
+
+		if (f.set.juliaConstant == glm::vec4(0.01f))
+		{
+			z += glm::vec4(1.0f);
+		}
+
+		if (glm::dot(z, z) > ESCAPE_THRESHOLD)
+		{
+			break;
+		}
+	}
+
+	return glm::normalize(glm::vec3(glm::dot(J0, z), glm::dot(J1, z), glm::dot(J2, z)));
+}
+
+static const float TETRA_NORMAL_OFFSET = 0.001f;
+
+// tetrahedron taps, p + TETRA_NORMAL_OFFSET * tetraTaps[i]
+static const glm::vec3 tetraTaps[4] = {
+	glm::vec3( 1.0f, -1.0f, -1.0f),
+	glm::vec3(-1.0f, -1.0f,  1.0f),
+	glm::vec3(-1.0f,  1.0f, -1.0f),
+	glm::vec3( 1.0f,  1.0f,  1.0f),
+};
+
+// gradient from four direct distance bounds instead of six marches
+inline glm::vec3 tetraNorm(const juliaFrame& f, const glm::vec3& p)
+{
+	glm::vec3 n(0.0f);
+	for (const glm::vec3& k : tetraTaps)
+		n += k * distanceBound(f, p + k * TETRA_NORMAL_OFFSET);
+	return glm::normalize(n);
+}
+
+inline glm::vec3 surfaceNormal(const juliaFrame& f, const glm::vec3& p)
+{
+	switch (static_cast<normalMethod>(f.set.normalMode))
+	{
+	case normalMethod::tetrahedral:
+		return tetraNorm(f, p);
+	case normalMethod::centralDifference:
+		return estimateNorm(f, p);
+	default:
+		return analyticNorm(f, p);
+	}
+}
+
+inline glm::vec3 shadePhong(const juliaFrame& f, const glm::vec3& L, const glm::vec3& P, const glm::vec3& N)
+{
+	glm::vec3 diffuse = f.set.diffuseColor;
+	const float specExp = 10.0f;
+	const float specularity = f.set.specularity;
+
+	glm::vec3 light = glm::normalize(L - P);
+	glm::vec3 eye = glm::normalize(f.camPos - P);
+	float nDotL = glm::dot(N, light);
+	glm::vec3 R = light - 2.0f * nDotL * N;
+
+	diffuse += glm::abs(N) * 0.3f;
+
+	return diffuse * std::max(nDotL, 0.0f) + glm::vec3(specularity * std::pow(std::max(glm::dot(eye, R), 0.0f), specExp));
+}
+
+// hits further apart than this fraction of the nearer one are treated as a depth edge
+const float AA_DEPTH_EDGE = 0.02f;
+
+// running statistics of one pixel's samples, adaptive anti-aliasing stops on them
+struct sampleStats
+{
+	glm::vec3 sum = glm::vec3(0.0f);
+	glm::vec3 sumSq = glm::vec3(0.0f);
+	int count = 0;
+	int hits = 0;
+	float nearT = 0.0f;     // nearest and furthest hit distance, only meaningful once hits > 0
+	float farT = 0.0f;
+
+	void add(const glm::vec3& col, bool hit, float t)
+	{
+		sum += col;
+		sumSq += col * col;
+		count++;
+		if (hit)
+		{
+			nearT = hits > 0 ? std::min(nearT, t) : t;
+			farT = hits > 0 ? std::max(farT, t) : t;
+			hits++;
+		}
+	}
+
+	// true once more samples are not expected to change the pixel
+	bool settled(float threshold) const
+	{
+		// silhouette or one surface in front of another inside the pixel
+		if (hits > 0 && hits < count)
+			return false;
+		if (hits > 0 && farT - nearT > AA_DEPTH_EDGE * nearT)
+			return false;
+
+		// standard error of the mean below the threshold, sqrt(var / n) <= threshold
+		glm::vec3 mean = sum / float(count);
+		glm::vec3 var = glm::max(sumSq / float(count) - mean * mean, glm::vec3(0.0f));
+		return std::max(var.x, std::max(var.y, var.z)) <= threshold * threshold * float(count);
+	}
+};
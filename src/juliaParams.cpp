@@ -0,0 +1,120 @@
+#include "juliaParams.h"
+
+#include <cstring>
+
+juliaParams::juliaParams()
+    : UBO_ID(0), dirty(true)
+{
+    memset(&block, 0, sizeof(block));
+    setRotation(glm::mat3(1.0f));
+    block.boundingRadius = BOUNDING_SPHERE_RADIUS;
+
+    glGenBuffers(1, &UBO_ID);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO_ID);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(juliaParamsStd140), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // bound once, programs pick it up through layout(binding = 0)
+    glBindBufferBase(GL_UNIFORM_BUFFER, JULIA_PARAMS_BINDING, UBO_ID);
+}
+
+juliaParams::~juliaParams()
+{
+    if (UBO_ID)
+        glDeleteBuffers(1, &UBO_ID);
+}
+
+void juliaParams::setSettings(const juliaSettings& set)
+{
+    block.juliaConstant = set.juliaConstant;
+    block.fov = set.fov;
+    block.epsilon = set.epsilon;
+    block.epsilonMode = set.epsilonMode;
+    block.maxMarchSteps = set.maxMarchSteps;
+    block.relaxation = set.relaxation;
+    block.maxSteps = set.maxIterations;
+    block.aaSamples = set.aaSamples;
+    block.normalMode = set.normalMode;
+    block.coneBlock = set.coneBlock;
+    block.maxAASamples = set.maxAASamples;
+    block.aaThreshold = set.aaThreshold;
+    block.samplePattern = set.samplePattern;
+    block.lightPos = set.lightPos;
+    block.specularity = set.specularity;
+    block.diffuseColor = set.diffuseColor;
+    block.backgroundColor = set.backgroundColor;
+    dirty = true;
+}
+
+void juliaParams::setCamera(glm::vec3 eye, glm::vec3 lookAt, glm::vec3 up, glm::vec2 resolution)
+{
+    block.camPos = eye;
+    block.camLookAt = lookAt;
+    block.camUp = up;
+    block.resolution = resolution;
+    dirty = true;
+}
+
+void juliaParams::setCamera(const camera& cam)
+{
+    setCamera(cam.getEye(), cam.getLookAt(), cam.getUp(), cam.getResolution());
+}
+
+void juliaParams::setResolution(glm::vec2 resolution)
+{
+    if (block.resolution == resolution)
+        return;
+    block.resolution = resolution;
+    dirty = true;
+}
+
+void juliaParams::setRotation(const glm::mat3& rotation)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        glm::vec4 column = glm::vec4(rotation[i], 0.0f);
+        if (block.rotation[i] != column)
+        {
+            block.rotation[i] = column;
+            dirty = true;
+        }
+    }
+}
+
+void juliaParams::setSamples(int aaSamples)
+{
+    if (block.aaSamples == aaSamples && block.maxAASamples == 0)
+        return;
+    block.aaSamples = aaSamples;
+    block.maxAASamples = 0;
+    dirty = true;
+}
+
+void juliaParams::setBoundingRadius(float radius)
+{
+    if (block.boundingRadius == radius)
+        return;
+    block.boundingRadius = radius;
+    dirty = true;
+}
+
+void juliaParams::setVolume(bool enabled, float radius)
+{
+    if (block.useVolume == static_cast<int>(enabled) && block.volumeRadius == radius)
+        return;
+    block.useVolume = enabled;
+    block.volumeRadius = radius;
+    dirty = true;
+}
+
+bool juliaParams::upload()
+{
+    if (!dirty)
+        return false;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO_ID);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(juliaParamsStd140), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    dirty = false;
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "common.h"
+#include "juliaSettings.h"
+#include "camera.h"
+
+// binding point of the juliaParams uniform block, every program that renders the set reads it from here
+static const unsigned int JULIA_PARAMS_BINDING = 0;
+
+// std140 mirror of the juliaParams block in juliaSet.frag, keep the two in the same order
+struct juliaParamsStd140
+{
+	glm::vec4 rotation[3];      // mat3 columns are padded to vec4
+	glm::vec4 juliaConstant;
+	glm::vec3 camPos;
+	float fov;
+	glm::vec3 camLookAt;
+	float epsilon;
+	glm::vec3 camUp;
+	int maxSteps;
+	glm::vec2 resolution;
+	int aaSamples;
+	int normalMode;
+	int coneBlock;
+	int maxAASamples;
+	float aaThreshold;
+	int samplePattern;
+	glm::vec3 lightPos;
+	float specularity;
+	glm::vec3 diffuseColor;
+	int epsilonMode;
+	glm::vec3 backgroundColor;
+	int maxMarchSteps;
+	float relaxation;
+	float boundingRadius;
+	int useVolume;
+	float volumeRadius;
+};
+static_assert(sizeof(juliaParamsStd140) == 208, "juliaParamsStd140 does not match the std140 layout");
+
+// owns the uniform buffer, fields are staged on the CPU and sent with one glBufferSubData per changed frame
+class juliaParams
+{
+public:
+	juliaParams();
+	~juliaParams();
+
+	void setSettings(const juliaSettings& set);
+	void setCamera(glm::vec3 eye, glm::vec3 lookAt, glm::vec3 up, glm::vec2 resolution);
+	void setCamera(const camera& cam);
+	void setResolution(glm::vec2 resolution);
+	void setRotation(const glm::mat3& rotation);
+	// fixed sample count per pass for accumulation, turns adaptive sampling off since the blend weights assume every pixel got aaSamples
+	void setSamples(int aaSamples);
+	// sphere the march starts on and gives up outside of, see tightBoundingRadius
+	void setBoundingRadius(float radius);
+	// march through the baked distanceVolume of half edge radius instead of iterating at every step
+	void setVolume(bool enabled, float radius);
+
+	// uploads the block if anything changed since the last call, returns true if it did
+	bool upload();
+
+	const juliaParamsStd140& data() const { return block; };
+private:
+	unsigned int UBO_ID;
+	juliaParamsStd140 block;
+	bool dirty;
+};
@@ -0,0 +1,276 @@
+#include "juliaSIMD.h"
+
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define JULIA_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define JULIA_SIMD_X86 0
+#endif
+
+// every ISA gets its own target region so the rest of the program stays baseline x86
+// gcc/clang need the region to emit the intrinsics, msvc accepts them anywhere
+
+#if JULIA_SIMD_X86
+
+// ---------------------------------------------------------------- SSE4.1, 4 lanes
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+namespace sse4Lanes
+{
+    struct L
+    {
+        typedef __m128 vec;
+        typedef __m128 mask;
+        static const int width = 4;
+
+        static vec load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, vec v) { _mm_storeu_ps(p, v); }
+        static vec set1(float v) { return _mm_set1_ps(v); }
+        static vec add(vec a, vec b) { return _mm_add_ps(a, b); }
+        static vec sub(vec a, vec b) { return _mm_sub_ps(a, b); }
+        static vec mul(vec a, vec b) { return _mm_mul_ps(a, b); }
+        static mask greater(vec a, vec b) { return _mm_cmpgt_ps(a, b); }
+        static mask andNot(mask m, mask off) { return _mm_andnot_ps(off, m); }
+        static vec select(mask m, vec a, vec b) { return _mm_blendv_ps(b, a, m); }
+        static bool any(mask m) { return _mm_movemask_ps(m) != 0; }
+        static mask allTrue() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+    };
+
+#include "juliaSIMDKernel.inl"
+
+    static void iterate(quatLanes q, quatLanes qp, int count, const float* c, int maxSteps)
+    {
+        iterateKernel<L>(q, qp, count, c, maxSteps);
+    }
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+// ---------------------------------------------------------------- AVX2, 8 lanes
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace avx2Lanes
+{
+    struct L
+    {
+        typedef __m256 vec;
+        typedef __m256 mask;
+        static const int width = 8;
+
+        static vec load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, vec v) { _mm256_storeu_ps(p, v); }
+        static vec set1(float v) { return _mm256_set1_ps(v); }
+        static vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+        static vec sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+        static vec mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+        static mask greater(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static mask andNot(mask m, mask off) { return _mm256_andnot_ps(off, m); }
+        static vec select(mask m, vec a, vec b) { return _mm256_blendv_ps(b, a, m); }
+        static bool any(mask m) { return _mm256_movemask_ps(m) != 0; }
+        static mask allTrue() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+    };
+
+#include "juliaSIMDKernel.inl"
+
+    static void iterate(quatLanes q, quatLanes qp, int count, const float* c, int maxSteps)
+    {
+        iterateKernel<L>(q, qp, count, c, maxSteps);
+    }
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+// ---------------------------------------------------------------- AVX-512F, 16 lanes
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+namespace avx512Lanes
+{
+    struct L
+    {
+        typedef __m512 vec;
+        typedef __mmask16 mask;
+        static const int width = 16;
+
+        static vec load(const float* p) { return _mm512_loadu_ps(p); }
+        static void store(float* p, vec v) { _mm512_storeu_ps(p, v); }
+        static vec set1(float v) { return _mm512_set1_ps(v); }
+        static vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+        static vec sub(vec a, vec b) { return _mm512_sub_ps(a, b); }
+        static vec mul(vec a, vec b) { return _mm512_mul_ps(a, b); }
+        static mask greater(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+        static mask andNot(mask m, mask off) { return static_cast<mask>(m & ~off); }
+        static vec select(mask m, vec a, vec b) { return _mm512_mask_blend_ps(m, b, a); }
+        static bool any(mask m) { return m != 0; }
+        static mask allTrue() { return static_cast<mask>(0xFFFF); }
+    };
+
+#include "juliaSIMDKernel.inl"
+
+    static void iterate(quatLanes q, quatLanes qp, int count, const float* c, int maxSteps)
+    {
+        iterateKernel<L>(q, qp, count, c, maxSteps);
+    }
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // JULIA_SIMD_X86
+
+
+simdISA detectISA()
+{
+#if JULIA_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+
+    // the os has to save ymm/zmm state across context switches as well
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool ymmState = (xcr0 & 0x6) == 0x6;
+    const bool zmmState = (xcr0 & 0xE6) == 0xE6;
+
+    bool avx2 = false, avx512f = false;
+    if (maxLeaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+        avx512f = (info[1] & (1 << 16)) != 0;
+    }
+
+    if (avx512f && zmmState) return simdISA::avx512;
+    if (avx2 && avx && ymmState) return simdISA::avx2;
+    if (sse41) return simdISA::sse4;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return simdISA::avx512;
+    if (__builtin_cpu_supports("avx2")) return simdISA::avx2;
+    if (__builtin_cpu_supports("sse4.1")) return simdISA::sse4;
+#endif
+#endif
+    return simdISA::scalar;
+}
+
+const char* isaName(simdISA isa)
+{
+    switch (isa)
+    {
+    case simdISA::sse4: return "sse4";
+    case simdISA::avx2: return "avx2";
+    case simdISA::avx512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+int isaWidth(simdISA isa)
+{
+    switch (isa)
+    {
+    case simdISA::sse4: return 4;
+    case simdISA::avx2: return 8;
+    case simdISA::avx512: return 16;
+    default: return 1;
+    }
+}
+
+void iterateIntersectLanes(quatLanes q, quatLanes qp, int count, const glm::vec4& juliaConstant, int maxSteps, simdISA isa)
+{
+    // never run code the cpu cannot execute
+    static const simdISA best = detectISA();
+    if (isa > best)
+        isa = best;
+
+    // the shader's special case for c == 0.01 is the same as iterating with c + 1
+    glm::vec4 c = juliaConstant;
+    if (juliaConstant == glm::vec4(0.01f))
+        c += glm::vec4(1.0f);
+    const float cLanes[4] = { c.x, c.y, c.z, c.w };
+
+    const int width = isaWidth(isa);
+    const int vectorCount = count - count % width;
+
+#if JULIA_SIMD_X86
+    switch (isa)
+    {
+    case simdISA::sse4: sse4Lanes::iterate(q, qp, vectorCount, cLanes, maxSteps); break;
+    case simdISA::avx2: avx2Lanes::iterate(q, qp, vectorCount, cLanes, maxSteps); break;
+    case simdISA::avx512: avx512Lanes::iterate(q, qp, vectorCount, cLanes, maxSteps); break;
+    default: break;
+    }
+#else
+    (void)cLanes;
+#endif
+
+    // tail that does not fill a whole vector, or everything when scalar
+    for (int i = (isa == simdISA::scalar) ? 0 : vectorCount; i < count; i++)
+    {
+        glm::vec4 z(q.x[i], q.y[i], q.z[i], q.w[i]);
+        glm::vec4 zp(qp.x[i], qp.y[i], qp.z[i], qp.w[i]);
+
+        iterateIntersect(z, zp, juliaConstant, maxSteps);
+
+        q.x[i] = z.x; q.y[i] = z.y; q.z[i] = z.z; q.w[i] = z.w;
+        qp.x[i] = zp.x; qp.y[i] = zp.y; qp.z[i] = zp.z; qp.w[i] = zp.w;
+    }
+}
+
+void distanceBoundLanes(const juliaFrame& frame, const float* px, const float* py, const float* pz, float* dist, int count, simdISA isa)
+{
+    // per thread scratch, render workers call this for every march step
+    thread_local std::vector<float> scratch;
+    if (scratch.size() < static_cast<size_t>(count) * 8)
+        scratch.resize(static_cast<size_t>(count) * 8);
+
+    float* base = scratch.data();
+    quatLanes q = { base, base + count, base + 2 * count, base + 3 * count };
+    quatLanes qp = { base + 4 * count, base + 5 * count, base + 6 * count, base + 7 * count };
+
+    const glm::mat3& R = frame.rotation;
+    for (int i = 0; i < count; i++)
+    {
+        glm::vec3 z = R * glm::vec3(px[i], py[i], pz[i]);
+        q.x[i] = z.x; q.y[i] = z.y; q.z[i] = z.z; q.w[i] = 0.0f;
+        qp.x[i] = 1.0f; qp.y[i] = 0.0f; qp.z[i] = 0.0f; qp.w[i] = 0.0f;
+    }
+
+    iterateIntersectLanes(q, qp, count, frame.set.juliaConstant, frame.set.maxIterations, isa);
+
+    // find lower bound on dist to julia set
+    for (int i = 0; i < count; i++)
+    {
+        float normZ = std::sqrt(q.x[i] * q.x[i] + q.y[i] * q.y[i] + q.z[i] * q.z[i] + q.w[i] * q.w[i]);
+        float d = std::max(std::sqrt(qp.x[i] * qp.x[i] + qp.y[i] * qp.y[i] + qp.z[i] * qp.z[i] + qp.w[i] * qp.w[i]), 1e-6f);
+        dist[i] = 0.5f * normZ * std::log(normZ) / d;
+    }
+}
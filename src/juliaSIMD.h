@@ -0,0 +1,32 @@
+#pragma once
+
+#include "juliaCPU.h"
+
+// instruction sets the lane kernels are built for, picked at runtime
+enum class simdISA
+{
+	scalar,
+	sse4,
+	avx2,
+	avx512
+};
+
+simdISA detectISA();                // best ISA this cpu supports
+const char* isaName(simdISA isa);
+int isaWidth(simdISA isa);          // lanes per vector
+
+// quaternions in SoA form, one array per component
+struct quatLanes
+{
+	float* x;
+	float* y;
+	float* z;
+	float* w;
+};
+
+// iterateIntersect on count points at once, q and qp are updated in place
+// escaped lanes are masked off instead of breaking, the loop ends once every lane has escaped
+void iterateIntersectLanes(quatLanes q, quatLanes qp, int count, const glm::vec4& juliaConstant, int maxSteps, simdISA isa);
+
+// dist[i] = distanceBound(frame, p[i]) for count points given in SoA form
+void distanceBoundLanes(const juliaFrame& frame, const float* px, const float* py, const float* pz, float* dist, int count, simdISA isa);
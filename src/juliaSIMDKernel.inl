@@ -0,0 +1,57 @@
+// lane kernel shared by every ISA in juliaSIMD.cpp
+// included once per target region with L bound to that ISA's lane type, so it must stay free of std/glm calls
+
+template<class L>
+static void iterateKernel(quatLanes q, quatLanes qp, int count, const float* c, int maxSteps)
+{
+    typedef typename L::vec vec;
+    typedef typename L::mask mask;
+
+    const vec cx = L::set1(c[0]);
+    const vec cy = L::set1(c[1]);
+    const vec cz = L::set1(c[2]);
+    const vec cw = L::set1(c[3]);
+    const vec two = L::set1(2.0f);
+    const vec threshold = L::set1(ESCAPE_THRESHOLD);
+
+    for (int i = 0; i + L::width <= count; i += L::width)
+    {
+        vec x = L::load(q.x + i), y = L::load(q.y + i), z = L::load(q.z + i), w = L::load(q.w + i);
+        vec a = L::load(qp.x + i), b = L::load(qp.y + i), d = L::load(qp.z + i), e = L::load(qp.w + i);
+
+        mask active = L::allTrue();
+        for (int s = 0; s < maxSteps; s++)
+        {
+            // qp = 2.0 * quartMult(q, qp)
+            vec na = L::mul(two, L::sub(L::mul(x, a), L::add(L::add(L::mul(y, b), L::mul(z, d)), L::mul(w, e))));
+            vec nb = L::mul(two, L::add(L::add(L::mul(x, b), L::mul(a, y)), L::sub(L::mul(z, e), L::mul(w, d))));
+            vec nd = L::mul(two, L::add(L::add(L::mul(x, d), L::mul(a, z)), L::sub(L::mul(w, b), L::mul(y, e))));
+            vec ne = L::mul(two, L::add(L::add(L::mul(x, e), L::mul(a, w)), L::sub(L::mul(y, d), L::mul(z, b))));
+
+            // q = quartSquared(q) + juliaConstant
+            vec x2 = L::mul(two, x);
+            vec nx = L::add(L::sub(L::mul(x, x), L::add(L::add(L::mul(y, y), L::mul(z, z)), L::mul(w, w))), cx);
+            vec ny = L::add(L::mul(x2, y), cy);
+            vec nz = L::add(L::mul(x2, z), cz);
+            vec nw = L::add(L::mul(x2, w), cw);
+
+            // lanes that already escaped keep the values they broke out with
+            a = L::select(active, na, a);
+            b = L::select(active, nb, b);
+            d = L::select(active, nd, d);
+            e = L::select(active, ne, e);
+            x = L::select(active, nx, x);
+            y = L::select(active, ny, y);
+            z = L::select(active, nz, z);
+            w = L::select(active, nw, w);
+
+            vec r = L::add(L::add(L::mul(nx, nx), L::mul(ny, ny)), L::add(L::mul(nz, nz), L::mul(nw, nw)));
+            active = L::andNot(active, L::greater(r, threshold));
+            if (!L::any(active))
+                break;
+        }
+
+        L::store(q.x + i, x); L::store(q.y + i, y); L::store(q.z + i, z); L::store(q.w + i, w);
+        L::store(qp.x + i, a); L::store(qp.y + i, b); L::store(qp.z + i, d); L::store(qp.w + i, e);
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// julia set is centered at origin, encapsulated by bounding sphere
+static const float BOUNDING_SPHERE_RADIUS = 2.0f;
+
+// how hit normals are computed, kept as an int in juliaSettings so it fits the uniform block and an ImGui combo
+enum class normalMethod
+{
+	analytic,           // gradient from the iteration's Jacobian, one extra iteration loop
+	tetrahedral,        // four direct distance bounds
+	centralDifference,  // six full deAt marches, the original reference
+	count
+};
+
+// command line and benchmark names, same order as normalMethod
+static const char* const normalMethodNames[] = { "analytic", "tetrahedral", "central" };
+static_assert(sizeof(normalMethodNames) / sizeof(normalMethodNames[0]) == static_cast<size_t>(normalMethod::count), "normalMethodNames out of sync with normalMethod");
+
+// what epsilon means, also an int in juliaSettings
+enum class epsilonMethod
+{
+	absolute,   // the same hit threshold for every ray
+	footprint,  // a multiple of the pixel footprint at the distance travelled, near rays refine more than far ones
+	count
+};
+
+// command line names, same order as epsilonMethod
+static const char* const epsilonMethodNames[] = { "absolute", "footprint" };
+static_assert(sizeof(epsilonMethodNames) / sizeof(epsilonMethodNames[0]) == static_cast<size_t>(epsilonMethod::count), "epsilonMethodNames out of sync with epsilonMethod");
+
+// where the AA samples land inside a pixel, also an int in juliaSettings
+enum class sampleSequence
+{
+	hash,   // fract(sin()) per sample index, the original jitter
+	r2,     // R2 sequence, Cranley-Patterson rotated per pixel by blue noise
+	sobol,  // first two Sobol dimensions, XOR scrambled per pixel by blue noise
+	count
+};
+
+// command line and benchmark names, same order as sampleSequence
+static const char* const sampleSequenceNames[] = { "hash", "r2", "sobol" };
+static_assert(sizeof(sampleSequenceNames) / sizeof(sampleSequenceNames[0]) == static_cast<size_t>(sampleSequence::count), "sampleSequenceNames out of sync with sampleSequence");
+
+// parameters shared by the GLSL and CPU renderers
+struct juliaSettings
+{
+	int aaSamples = 4;
+	int maxIterations = 80;
+	float epsilon = 1e-3f;  // hit threshold, or the footprint multiple in epsilonMethod::footprint
+	int epsilonMode = static_cast<int>(epsilonMethod::absolute);
+	int maxMarchSteps = 512;    // distance evaluations per ray before it is given up as a miss
+	float relaxation = 1.2f;    // over-relaxed step factor, 1 is plain sphere tracing
+	glm::vec4 juliaConstant = glm::vec4(-0.04f, 0.95f, 0.4f, -0.43f);
+	float fov = 90.0f;
+	int normalMode = static_cast<int>(normalMethod::analytic);
+	int coneBlock = 8;      // pixel block edge of the cone pre-pass, 0 marches every ray from the bounding sphere
+
+	// adaptive anti-aliasing, every pixel gets aaSamples and then rounds of aaSamples more until it settles
+	// a pixel settles once no silhouette or depth edge runs through it and the standard error of its mean is below aaThreshold
+	int maxAASamples = 0;   // per pixel budget, <= aaSamples renders the uniform aaSamples everywhere
+	float aaThreshold = 0.01f;
+	int samplePattern = static_cast<int>(sampleSequence::r2);
+
+	// shading only, a cached march stays valid when these change
+	glm::vec3 lightPos = glm::vec3(0.0f, 0.0f, 5.0f);
+	glm::vec3 diffuseColor = glm::vec3(0.0f, 1.0f, 0.25f);
+	float specularity = 0.45f;
+	glm::vec3 backgroundColor = glm::vec3(0.5f);
+};
+
+// one bit per juliaSettings field, so a change can be sorted into what it invalidates
+enum settingsField : unsigned
+{
+	FIELD_AA_SAMPLES       = 1u << 0,
+	FIELD_MAX_ITERATIONS   = 1u << 1,
+	FIELD_EPSILON          = 1u << 2,
+	FIELD_JULIA_CONSTANT   = 1u << 3,
+	FIELD_FOV              = 1u << 4,
+	FIELD_NORMAL_MODE      = 1u << 5,
+	FIELD_CONE_BLOCK       = 1u << 6,
+	FIELD_LIGHT_POS        = 1u << 7,
+	FIELD_DIFFUSE_COLOR    = 1u << 8,
+	FIELD_SPECULARITY      = 1u << 9,
+	FIELD_BACKGROUND_COLOR = 1u << 10,
+	FIELD_MAX_AA_SAMPLES   = 1u << 11,
+	FIELD_AA_THRESHOLD     = 1u << 12,
+	FIELD_SAMPLE_PATTERN   = 1u << 13,
+	FIELD_EPSILON_MODE     = 1u << 14,
+	FIELD_MAX_MARCH_STEPS  = 1u << 15,
+	FIELD_RELAXATION       = 1u << 16,
+};
+
+// fields that move hits or normals, anything cached from a march has to be redone
+static const unsigned GEOMETRY_FIELDS = FIELD_AA_SAMPLES | FIELD_MAX_ITERATIONS | FIELD_EPSILON | FIELD_JULIA_CONSTANT |
+                                        FIELD_FOV | FIELD_NORMAL_MODE | FIELD_CONE_BLOCK | FIELD_MAX_AA_SAMPLES | FIELD_AA_THRESHOLD |
+                                        FIELD_SAMPLE_PATTERN | FIELD_EPSILON_MODE | FIELD_MAX_MARCH_STEPS | FIELD_RELAXATION;
+// fields that only change how cached hits are lit
+static const unsigned SHADING_FIELDS = FIELD_LIGHT_POS | FIELD_DIFFUSE_COLOR | FIELD_SPECULARITY | FIELD_BACKGROUND_COLOR;
+
+// settingsField bits of every field that differs between a and b
+inline unsigned changedFields(const juliaSettings& a, const juliaSettings& b)
+{
+	unsigned changed = 0;
+	if (a.aaSamples != b.aaSamples) changed |= FIELD_AA_SAMPLES;
+	if (a.maxIterations != b.maxIterations) changed |= FIELD_MAX_ITERATIONS;
+	if (a.epsilon != b.epsilon) changed |= FIELD_EPSILON;
+	if (a.epsilonMode != b.epsilonMode) changed |= FIELD_EPSILON_MODE;
+	if (a.maxMarchSteps != b.maxMarchSteps) changed |= FIELD_MAX_MARCH_STEPS;
+	if (a.relaxation != b.relaxation) changed |= FIELD_RELAXATION;
+	if (a.juliaConstant != b.juliaConstant) changed |= FIELD_JULIA_CONSTANT;
+	if (a.fov != b.fov) changed |= FIELD_FOV;
+	if (a.normalMode != b.normalMode) changed |= FIELD_NORMAL_MODE;
+	if (a.coneBlock != b.coneBlock) changed |= FIELD_CONE_BLOCK;
+	if (a.maxAASamples != b.maxAASamples) changed |= FIELD_MAX_AA_SAMPLES;
+	if (a.aaThreshold != b.aaThreshold) changed |= FIELD_AA_THRESHOLD;
+	if (a.samplePattern != b.samplePattern) changed |= FIELD_SAMPLE_PATTERN;
+	if (a.lightPos != b.lightPos) changed |= FIELD_LIGHT_POS;
+	if (a.diffuseColor != b.diffuseColor) changed |= FIELD_DIFFUSE_COLOR;
+	if (a.specularity != b.specularity) changed |= FIELD_SPECULARITY;
+	if (a.backgroundColor != b.backgroundColor) changed |= FIELD_BACKGROUND_COLOR;
+	return changed;
+}
@@ -6,16 +6,69 @@
 
 #include "shader.h"
 #include "camera.h"
+#include "renderTarget.h"
+#include "resolutionController.h"
+#include "gpuTimer.h"
+#include "perfOverlay.h"
+#include "conePrepass.h"
+#include "temporalCache.h"
+#include "gBuffer.h"
+#include "blueNoiseTexture.h"
+#include "marchCounter.h"
+#include "boundingSphere.h"
+#include "distanceVolume.h"
+#include "frameCapture.h"
+#include "shaderVariants.h"
+
+#include <ctime>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
 
 camera* pCam = nullptr;
 shader* pShader = nullptr;
+juliaParams* pParams = nullptr;
 
 float WIDTH = 1280.f;
 float HEIGHT = 720.0f;
 
+// renders a few samples per frame and blends them into a running average while the view is static
+struct progressiveState
+{
+    bool enabled = false;
+    int samplesPerFrame = 1;
+    int maxSamples = 1024;
+    int accumulated = 0;
+};
+
+// renders the fractal at a fraction of the window size, scaled to hold a frame time budget
+struct dynamicResolutionState
+{
+    bool enabled = false;
+    resolutionController controller;
+    int idleFrames = 0;     // frames since the view last changed
+    // timer results arrive a few frames late, those of frames rendered at another size measured the old cost
+    int renderedWidth = 0;
+    int renderedHeight = 0;
+    long long sizeFrame = 0;    // first frame rendered at the current size
+};
+
+// marches through a distance volume baked for the current constant, so turning the view skips most iterations
+// baking waits until the constant has stopped moving, a slider drag would otherwise bake every frame
+struct bakedVolumeState
+{
+    bool enabled = false;
+    int idleFrames = 0;     // frames since the constant or iteration count last changed
+    int bakeDelay = 15;
+};
+
+// how the fractal gets into the offscreen target
+enum class renderPath
+{
+    fragment,   // full screen quad through juliaSet.frag
+    compute     // 8x8 workgroups of juliaSet.comp writing with imageStore
+};
+
 int main(void)
 {
     if (!glfwInit()) {
@@ -60,9 +113,51 @@ int main(void)
     pShader = &newShader;
     camera newCam = camera(WIDTH, HEIGHT);
     pCam = &newCam;
-    pShader->bindVF();              // ok since we only got 1 shader
-    pCam->setUniforms(pShader);
-    pShader->updateSettings();
+    juliaParams newParams;
+    pParams = &newParams;
+    pParams->setCamera(*pCam);
+    pShader->updateSettings(pParams);
+
+    // progressive accumulation, float target so the running average does not band
+    shader presentShader("shaders/render.vert", "shaders/present.frag");
+    shader computeShader("shaders/juliaSet.comp");
+    // the same programs with the loop counts and normal mode compiled in, built in the background
+    shaderVariants variants(window);
+    bool specializeShaders = variants.valid();
+    int renderPathIndex = static_cast<int>(renderPath::fragment);
+    conePrepass cone;
+    // block the cone distances were last computed from, lighting edits leave them valid
+    juliaParamsStd140 coneParams = {};
+    temporalCache temporal;
+    bool reprojectionEnabled = temporal.valid();
+    gBuffer deferred;
+    bool deferredEnabled = deferred.valid();
+    distanceVolume volume;
+    bakedVolumeState bakedVolume;
+    blueNoiseTexture sampleNoise;
+    sampleNoise.bind();
+    boundingSphereUpdater bounds;
+    bounds.request(pShader->currSet, static_cast<int>(HEIGHT));
+    juliaSettings boundsSet = pShader->currSet;     // settings and height the latest request was for
+    int boundsRows = static_cast<int>(HEIGHT);
+    // offscreen target for progressive and dynamic resolution, linear filtering upscales it to the window
+    // the second attachment keeps each pixel's hit distance for reprojection
+    renderTarget frameTarget({ GL_RGBA32F, GL_R32F }, GL_LINEAR);
+    progressiveState progressive;
+    dynamicResolutionState dynamicRes;
+    double lastFrameTime = glfwGetTime();
+
+    // GPU time of the fractal pass (including the present blit) and of the UI pass
+    gpuTimer fractalTimer;
+    gpuTimer uiTimer;
+    // rays of the fractal pass that ran out of march steps
+    marchCounter exhaustedCounter;
+    perfOverlay perf;
+    long long frameIndex = 0;
+    // window recording, read back through pixel buffers so capturing does not cost the frame rate
+    frameCapture recorder;
+    int captureFormat = 0;
+    int captureCount = 0;   // recordings started within the same second would otherwise share a prefix
 
     // full screen quad VAO 
     float quadVerts[] = {
@@ -89,6 +184,8 @@ int main(void)
 
     // uniforms
     float epsilonValues[] = { 1e-1f,1e-2f,1e-3f,1e-4f,1e-5f,1e-6f };
+    // the same combo picks a multiple of the pixel footprint in the footprint mode
+    float footprintScales[] = { 2.0f, 1.0f, 0.5f, 0.25f, 0.125f, 0.0625f };
     int epsilonIndex = 2;
 
     while (!glfwWindowShouldClose(window)) 
@@ -97,7 +194,7 @@ int main(void)
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        ImGui::SetNextWindowSize(ImVec2(650, 270), ImGuiCond_Always);
+        ImGui::SetNextWindowSize(ImVec2(650, 900), ImGuiCond_Always);
         ImGui::SetNextWindowPos(ImVec2(20, 20), ImGuiCond_Always);
 
         ImGui::Begin("Shader Controls");
@@ -123,31 +220,353 @@ int main(void)
         ImGui::Text("k");
         ImGui::PopItemWidth();
 
-        ImGui::Combo("Epsilon", &epsilonIndex, "1e-1\0 1e-2\0 1e-3\0 1e-4\0 1e-5\0 1e-6\0");
-        pShader->currSet.epsilon = epsilonValues[epsilonIndex];
+        ImGui::Combo("Epsilon Mode", &pShader->currSet.epsilonMode, "Absolute\0Pixel Footprint\0");
+        if (pShader->currSet.epsilonMode == static_cast<int>(epsilonMethod::footprint))
+        {
+            ImGui::Combo("Epsilon (x footprint)", &epsilonIndex, "2\0 1\0 1/2\0 1/4\0 1/8\0 1/16\0");
+            pShader->currSet.epsilon = footprintScales[epsilonIndex];
+        }
+        else
+        {
+            ImGui::Combo("Epsilon", &epsilonIndex, "1e-1\0 1e-2\0 1e-3\0 1e-4\0 1e-5\0 1e-6\0");
+            pShader->currSet.epsilon = epsilonValues[epsilonIndex];
+        }
         ImGui::SliderInt("AA Samples", &pShader->currSet.aaSamples, 1, 32);
+        ImGui::Combo("Sample Pattern", &pShader->currSet.samplePattern, "Hash\0R2 + Blue Noise\0Sobol + Blue Noise\0");
+        // accumulation already spends its samples everywhere, adaptive sampling only applies to single frames
+        ImGui::SliderInt("Adaptive AA Budget (0 = off)", &pShader->currSet.maxAASamples, 0, 64);
+        if (pShader->currSet.maxAASamples > pShader->currSet.aaSamples)
+            ImGui::SliderFloat("Adaptive AA Threshold", &pShader->currSet.aaThreshold, 0.001f, 0.05f, "%.3f");
         ImGui::SliderInt("Max Iterations", &pShader->currSet.maxIterations, 1, 200);
+        ImGui::SliderInt("Max March Steps", &pShader->currSet.maxMarchSteps, 16, 2048);
+        ImGui::SliderFloat("Step Relaxation", &pShader->currSet.relaxation, 1.0f, 1.9f, "%.2f");
+        ImGui::Text("Bounding Radius %.3f", pParams->data().boundingRadius);
+        ImGui::Combo("Normals", &pShader->currSet.normalMode, "Analytic\0Tetrahedral\0Central (6 marches)\0");
+        if (cone.valid())
+            ImGui::SliderInt("Cone Block (0 = off)", &pShader->currSet.coneBlock, 0, 32);
+
+        if (temporal.valid())
+            ImGui::Checkbox("Reprojection", &reprojectionEnabled);
+
+        ImGui::DragFloat3("Light Position", &pShader->currSet.lightPos.x, 0.05f, -10.0f, 10.0f);
+        ImGui::ColorEdit3("Diffuse", &pShader->currSet.diffuseColor.x);
+        ImGui::SliderFloat("Specularity", &pShader->currSet.specularity, 0.0f, 1.0f);
+        ImGui::ColorEdit3("Background", &pShader->currSet.backgroundColor.x);
+        if (deferred.valid())
+            ImGui::Checkbox("Cache Geometry (G-buffer)", &deferredEnabled);
+        if (volume.valid())
+        {
+            ImGui::Checkbox("Baked Distance Volume", &bakedVolume.enabled);
+            if (bakedVolume.enabled)
+            {
+                ImGui::SameLine();
+                if (volume.ready())
+                    ImGui::Text("%d bricks, %.1f MB", volume.brickCount(), volume.bytes() / (1024.0 * 1024.0));
+                else
+                    ImGui::TextUnformatted("waiting for the constant to settle");
+            }
+        }
+
+        bool progressiveChanged = false;
+        if (computeShader.getComp_ID())
+            progressiveChanged |= ImGui::Combo("Render Path", &renderPathIndex, "Fragment\0Compute\0");
+        const bool useCompute = static_cast<renderPath>(renderPathIndex) == renderPath::compute;
+        if (variants.valid())
+        {
+            ImGui::Checkbox("Specialized Shaders", &specializeShaders);
+            if (specializeShaders && variants.compiling())
+            {
+                ImGui::SameLine();
+                ImGui::TextUnformatted("compiling");
+            }
+        }
+
+        progressiveChanged |= ImGui::Checkbox("Progressive", &progressive.enabled);
+        if (progressive.enabled)
+        {
+            ImGui::SameLine();
+            ImGui::PushItemWidth(120.0f);
+            progressiveChanged |= ImGui::SliderInt("Samples / Frame", &progressive.samplesPerFrame, 1, 8);
+            ImGui::PopItemWidth();
+            ImGui::Text("Accumulated %d / %d samples", std::min(progressive.accumulated, progressive.maxSamples), progressive.maxSamples);
+        }
+
+        if (ImGui::Checkbox("Dynamic Resolution", &dynamicRes.enabled))
+            dynamicRes.controller.reset();
+        if (dynamicRes.enabled)
+        {
+            ImGui::SameLine();
+            ImGui::PushItemWidth(120.0f);
+            ImGui::SliderFloat("Budget (ms)", &dynamicRes.controller.targetMs, 8.0f, 50.0f, "%.1f");
+            ImGui::PopItemWidth();
+            ImGui::Text("Render scale %.2f (%d x %d)", frameTarget.width() / pCam->getResolution().x, frameTarget.width(), frameTarget.height());
+        }
+
+        ImGui::Separator();
+        if (!recorder.recording())
+        {
+            ImGui::Combo("Capture Format", &captureFormat, "QOI\0PNG\0");
+            if (ImGui::Button("Record Frames"))
+            {
+                char prefix[64];
+                std::time_t now = std::time(nullptr);
+                std::strftime(prefix, sizeof(prefix), "capture_%Y%m%d_%H%M%S", std::localtime(&now));
+                recorder.start(std::string(prefix) + "_" + std::to_string(captureCount++), captureFormat == 0 ? ".qoi" : ".png");
+            }
+        }
+        else if (ImGui::Button("Stop Recording"))
+        {
+            recorder.stop();
+        }
+        if (recorder.captured() > 0)
+            ImGui::Text("%d captured, %d written, %d dropped, %d failed", recorder.captured(), recorder.written(), recorder.dropped(), recorder.failed());
 
         ImGui::End();
+
+        perf.draw();
         ImGui::Render();
 
+        const double frameStart = glfwGetTime();
+        const float frameMs = static_cast<float>((frameStart - lastFrameTime) * 1000.0);
+        lastFrameTime = frameStart;
+
+        const float lastYaw = pCam->yaw;
+        const float lastPitch = pCam->pitch;
         processInput(window);
-        if (pShader->settingsChanged())
+        bool viewChanged = pCam->yaw != lastYaw || pCam->pitch != lastPitch;
+
+        // anything but rotation moves the surface, so last frame's hit distances are worthless
+        // shading fields leave the surface alone, the cached samples only need lighting again
+        const unsigned changedSettings = pShader->settingsChanged();
+        if (changedSettings || progressiveChanged)
         {
-            pCam->setUniforms(pShader);
-            pShader->updateSettings();
+            if ((changedSettings & GEOMETRY_FIELDS) || progressiveChanged)
+            {
+                temporal.invalidate();
+                viewChanged = true;
+            }
+            pParams->setCamera(*pCam);
+            pShader->updateSettings(pParams);
+            if (progressive.enabled)
+                pParams->setSamples(progressive.samplesPerFrame);
+        }
+
+        // a settled constant has been in the uploaded block for a while, which is what the bake reads
+        if (changedSettings & VOLUME_FIELDS)
+        {
+            volume.invalidate();
+            bakedVolume.idleFrames = 0;
+        }
+        else
+        {
+            bakedVolume.idleFrames++;
+        }
+        if (bakedVolume.enabled && volume.valid() && !volume.ready() && bakedVolume.idleFrames >= bakedVolume.bakeDelay)
+            volume.bake(pParams->data().boundingRadius);
+        pParams->setVolume(bakedVolume.enabled && volume.ready(), volume.radius());
+        dynamicRes.idleFrames = viewChanged ? 0 : dynamicRes.idleFrames + 1;
+
+        // query results arrive a few frames late and are matched back to their frame by tag
+        long long timedFrame = 0;
+        float timedMs = 0.0f;
+        bool fractalTimed = false;
+        float fractalMs = 0.0f;
+        while (fractalTimer.poll(timedFrame, timedMs))
+        {
+            perf.setGpuTime(perfPass::fractal, timedFrame, timedMs);
+            if (timedFrame >= dynamicRes.sizeFrame)
+            {
+                fractalMs = timedMs;
+                fractalTimed = true;
+            }
+        }
+        while (uiTimer.poll(timedFrame, timedMs))
+            perf.setGpuTime(perfPass::ui, timedFrame, timedMs);
+        unsigned int exhausted = 0;
+        while (exhaustedCounter.poll(timedFrame, exhausted))
+            perf.setExhaustedRays(timedFrame, exhausted);
+        recorder.poll();
+
+        const int fbWidth = static_cast<int>(pCam->getResolution().x);
+        const int fbHeight = static_cast<int>(pCam->getResolution().y);
+
+        // while accumulating a static view there is no frame budget to hold, converge at full resolution
+        // the fractal GPU time is not quantised by vsync, so it drives the controller whenever a result of the current size is in
+        float renderScale = 1.0f;
+        if (dynamicRes.enabled && !(progressive.enabled && dynamicRes.idleFrames > 1))
+        {
+            if (fractalTimed)
+                dynamicRes.controller.update(fractalMs);
+            renderScale = dynamicRes.controller.scale();
+        }
+
+        // the G-buffer holds one march per sample, accumulation would need a new one every frame
+        // and adaptive sampling does not know its sample count up front
+        const bool useDeferred = deferredEnabled && deferred.valid() && !progressive.enabled &&
+                                 pShader->currSet.aaSamples <= GBUFFER_MAX_SAMPLES && pShader->currSet.maxAASamples <= pShader->currSet.aaSamples;
+        if (viewChanged || !useDeferred)
+            deferred.invalidate();
+
+        // image stores need a texture to land in, so the compute path always renders offscreen
+        // so do reprojected hit distances and the shaded G-buffer
+        const bool offscreen = progressive.enabled || dynamicRes.enabled || useCompute || reprojectionEnabled || useDeferred;
+        const int renderWidth = offscreen ? std::max(1, static_cast<int>(fbWidth * renderScale)) : fbWidth;
+        const int renderHeight = offscreen ? std::max(1, static_cast<int>(fbHeight * renderScale)) : fbHeight;
+        pParams->setResolution(glm::vec2(renderWidth, renderHeight));
+        if (renderWidth != dynamicRes.renderedWidth || renderHeight != dynamicRes.renderedHeight)
+        {
+            dynamicRes.renderedWidth = renderWidth;
+            dynamicRes.renderedHeight = renderHeight;
+            dynamicRes.sizeFrame = frameIndex;
+        }
+
+        // the tight radius is measured off the render thread, the loose sphere holds every set until it arrives
+        // footprint thresholds follow the rendered height, so under footprint mode a new size needs a new radius
+        if (boundingRadiusStale(boundsSet, boundsRows, pShader->currSet, renderHeight))
+        {
+            pParams->setBoundingRadius(BOUNDING_SPHERE_RADIUS);
+            bounds.request(pShader->currSet, renderHeight);
+            boundsSet = pShader->currSet;
+            boundsRows = renderHeight;
+        }
+        float measuredRadius = 0.0f;
+        if (bounds.poll(measuredRadius))
+            pParams->setBoundingRadius(measuredRadius);
+
+        perf.beginFrame(frameIndex, frameMs, renderWidth, renderHeight, pShader->currSet);
+
+        // any change to the parameter block (settings, rotation, resolution) restarts accumulation
+        const bool paramsChanged = pParams->upload();
+        if (paramsChanged)
+            progressive.accumulated = 0;
+
+        // the G-buffer passes are never specialized, asking for a variant there would only compile it for nothing
+        shader* fragmentProgram = pShader;
+        shader* computeProgram = &computeShader;
+        if (specializeShaders && !useDeferred)
+        {
+            shader* variant = variants.find(useCompute ? variantProgram::compute : variantProgram::fragment, pParams->data());
+            if (variant)
+                (useCompute ? computeProgram : fragmentProgram) = variant;
         }
 
         glBindVertexArray(quadVAO);
 
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        fractalTimer.begin(frameIndex);
+        exhaustedCounter.begin(frameIndex);
+
+        // start distances only move with the view, the geometry, the sphere the rays start on and the resolution
+        // a static view keeps reusing them, so do shading-only edits
+        if (pShader->currSet.coneBlock > 0)
+        {
+            const juliaParamsStd140& block = pParams->data();
+            const bool coneStale = viewChanged || block.resolution != coneParams.resolution || block.boundingRadius != coneParams.boundingRadius ||
+                                   block.useVolume != coneParams.useVolume || block.volumeRadius != coneParams.volumeRadius;
+            if (cone.update(renderWidth, renderHeight, pShader->currSet.coneBlock, coneStale))
+                coneParams = block;
+            cone.bind();
+        }
+        if (offscreen)
+        {
+            if (frameTarget.resize(renderWidth, renderHeight))
+            {
+                progressive.accumulated = 0;
+                temporal.invalidate();
+            }
+
+            // converged, keep presenting the finished image
+            if (!progressive.enabled || progressive.accumulated < progressive.maxSamples)
+            {
+                const int sampleOffset = progressive.enabled ? progressive.accumulated : 0;
+
+                // a static view being accumulated gains nothing, new samples march in full
+                // neither does a G-buffer that is not going to march
+                const glm::mat3 rotation = pCam->rotationMat();
+                bool reprojected = false;
+                if (reprojectionEnabled && !(progressive.enabled && progressive.accumulated > 0) && !(useDeferred && deferred.cachedGeometry()))
+                {
+                    reprojected = temporal.reproject(frameTarget.texture(1), renderWidth, renderHeight, rotation);
+                    temporal.bind();
+                }
+
+                if (useDeferred)
+                {
+                    // the target only goes stale when something in the parameter block changed
+                    const bool marched = deferred.march(renderWidth, renderHeight, pShader->currSet.aaSamples, reprojected);
+                    if (marched || paramsChanged)
+                    {
+                        frameTarget.bind();
+                        deferred.shade();
+                    }
+                }
+                else if (useCompute)
+                {
+                    // the shader blends into the running average itself
+                    computeProgram->bindComp();
+                    computeProgram->setUniform1i(uniformID::sampleOffset, sampleOffset);
+                    computeProgram->setUniform1i(uniformID::useReprojection, reprojected);
+                    glBindImageTexture(0, frameTarget.texture(0), 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+                    glBindImageTexture(HIT_DEPTH_IMAGE_UNIT, frameTarget.texture(1), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+                    computeProgram->dispatchCompute(renderWidth, renderHeight);
+                    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+                }
+                else
+                {
+                    frameTarget.bind();
+                    fragmentProgram->bindVF();
+                    fragmentProgram->setUniform1i(uniformID::sampleOffset, sampleOffset);
+                    fragmentProgram->setUniform1i(uniformID::useReprojection, reprojected);
+
+                    // blending with weight n / (total + n) keeps the target equal to the mean of every sample so far
+                    // hit distances are overwritten, not averaged
+                    if (progressive.enabled)
+                    {
+                        const float weight = static_cast<float>(progressive.samplesPerFrame) / (progressive.accumulated + progressive.samplesPerFrame);
+                        glEnable(GL_BLEND);
+                        glDisablei(GL_BLEND, 1);
+                        glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+                        glBlendColor(0.0f, 0.0f, 0.0f, weight);
+                    }
+                    glDrawArrays(GL_TRIANGLES, 0, 6);
+                    glDisable(GL_BLEND);
+                }
+
+                if (progressive.enabled)
+                    progressive.accumulated += progressive.samplesPerFrame;
+                temporal.frameRendered(rotation);
+            }
+
+            renderTarget::bindDefault(fbWidth, fbHeight);
+            presentShader.bindVF();
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, frameTarget.texture(0));
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+        }
+        else
+        {
+            renderTarget::bindDefault(fbWidth, fbHeight);
+            fragmentProgram->bindVF();
+            fragmentProgram->setUniform1i(uniformID::sampleOffset, 0);
+            fragmentProgram->setUniform1i(uniformID::useReprojection, 0);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+        }
+        exhaustedCounter.end();
+        fractalTimer.end();
+
+        // the recording leaves the UI out
+        recorder.capture(fbWidth, fbHeight);
 
+        uiTimer.begin(frameIndex);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        uiTimer.end();
+        frameIndex++;
 
         glfwSwapBuffers(window); 
         glfwPollEvents();
     }
 
+    recorder.finish();
+    variants.stop();
     glfwTerminate();
 
     return 0;
@@ -158,7 +577,7 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     glViewport(0, 0, width, height);
     // update camera resolution & uniform
     pCam->updateResolution(static_cast<float>(width), static_cast<float>(height));
-    pShader->setUniformV2("resolution", pCam->getResolution());
+    pParams->setResolution(pCam->getResolution());
 }
 
 void processInput(GLFWwindow* window)
@@ -174,6 +593,6 @@ void processInput(GLFWwindow* window)
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) pCam->pitch += speed;
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) pCam->pitch -= speed;
 
-    pShader->setUniformMat3("rotation", pCam->rotationMat());
+    pParams->setRotation(pCam->rotationMat());
 }
 
@@ -0,0 +1,102 @@
+#include "marchCounter.h"
+
+#include <algorithm>
+
+static GLuint createCounterBuffer()
+{
+	GLuint buffer = 0;
+	const GLuint zero = 0;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), &zero, GL_DYNAMIC_READ);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	return buffer;
+}
+
+marchCounter::marchCounter(int ringSize)
+	: ring(std::max(ringSize, 2)), scratch(createCounterBuffer()), writeIndex(0), readIndex(0), active(false), latestCount(0)
+{
+	for (slot& s : ring)
+	{
+		s.buffer = createCounterBuffer();
+		s.fence = nullptr;
+		s.tag = 0;
+		s.pending = false;
+	}
+
+	// programs that run before the first begin() still need somewhere to count
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MARCH_COUNTER_BINDING, scratch);
+}
+
+marchCounter::~marchCounter()
+{
+	for (slot& s : ring)
+	{
+		if (s.fence)
+			glDeleteSync(s.fence);
+		glDeleteBuffers(1, &s.buffer);
+	}
+	glDeleteBuffers(1, &scratch);
+}
+
+void marchCounter::begin(long long tag)
+{
+	slot& s = ring[writeIndex];
+	if (s.pending)
+	{
+		// ring is full, reading now would stall
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MARCH_COUNTER_BINDING, scratch);
+		return;
+	}
+
+	const GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, s.buffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MARCH_COUNTER_BINDING, s.buffer);
+
+	s.tag = tag;
+	active = true;
+}
+
+void marchCounter::end()
+{
+	if (!active)
+		return;
+
+	// the count is read with glGetBufferSubData, which sees shader writes after this barrier
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	slot& s = ring[writeIndex];
+	s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	s.pending = true;
+	writeIndex = (writeIndex + 1) % static_cast<int>(ring.size());
+	active = false;
+}
+
+bool marchCounter::poll(long long& tag, unsigned int& exhausted)
+{
+	slot& s = ring[readIndex];
+	if (!s.pending)
+		return false;
+
+	const GLenum status = glClientWaitSync(s.fence, 0, 0);
+	if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		return false;
+
+	glDeleteSync(s.fence);
+	s.fence = nullptr;
+
+	GLuint count = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, s.buffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &count);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	s.pending = false;
+	readIndex = (readIndex + 1) % static_cast<int>(ring.size());
+
+	tag = s.tag;
+	exhausted = count;
+	latestCount = count;
+	return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "common.h"
+
+// shader storage binding of the marchCounters block in juliaCommon.glsl
+static const unsigned int MARCH_COUNTER_BINDING = 0;
+
+// number of rays that ran out of MAX_MARCH_STEPS, counted on the GPU and read back a few frames later
+// from a ring of buffers behind fences, the same way gpuTimer keeps the CPU from waiting
+class marchCounter
+{
+public:
+	explicit marchCounter(int ringSize = 4);
+	~marchCounter();
+
+	marchCounter(const marchCounter&) = delete;
+	marchCounter& operator=(const marchCounter&) = delete;
+
+	// zeroes the next buffer of the ring and binds it for the passes that follow
+	// if every buffer is still in flight the passes count into a scratch buffer that is never read
+	void begin(long long tag);
+	void end();
+
+	// collects the oldest finished count, returns false if none are ready yet
+	bool poll(long long& tag, unsigned int& exhausted);
+
+	unsigned int lastCount() const { return latestCount; };
+private:
+	struct slot
+	{
+		GLuint buffer;
+		GLsync fence;
+		long long tag;
+		bool pending;
+	};
+
+	std::vector<slot> ring;
+	GLuint scratch;
+	int writeIndex;
+	int readIndex;
+	bool active;
+	unsigned int latestCount;
+};
@@ -0,0 +1,377 @@
+// polygonises the julia set into a triangle mesh, no window, no GL context
+// samples distanceBound (same iterateIntersect as both renderers) on a regular grid over the cube around
+// tightBoundingRadius and extracts the surface where it crosses the hit threshold with marching tetrahedra:
+// every cell is split into six tetrahedra along its main diagonal, which needs no ambiguity table and gives
+// neighbouring cells matching faces, so the surface closes without cracks
+//
+// the grid is processed in z slabs of cell layers, one slab per thread at a time, and every finished slab is
+// streamed to the file in order, so memory stays at threads * (slab + 1) sample layers plus those slabs' triangles
+// vertices sit on grid edges and are shared between the tetrahedra and slabs that touch them
+//
+// usage: meshExport [options] --out mesh.ply|mesh.obj
+//   --resolution N      cells per axis (256)
+//   --slab N            cell layers per slab (8)
+//   --iterations N      max quaternion iterations
+//   --epsilon E         iso level, the absolute hit threshold of the renderers
+//   --c w,i,j,k         julia constant
+//   --threads N         0 = all cores
+//   --isa scalar|sse4|avx2|avx512
+
+#include "boundingSphere.h"
+#include "juliaSIMD.h"
+#include "meshWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+// the six tetrahedra of a cell as corner indices (bit 0 = +x, bit 1 = +y, bit 2 = +z)
+// each walks from corner 0 to corner 7 one axis at a time, so every corner holds the bits of the ones before it
+static const int CELL_TETRAHEDRA[6][4] = {
+    { 0, 1, 3, 7 }, { 0, 1, 5, 7 }, { 0, 2, 3, 7 },
+    { 0, 2, 6, 7 }, { 0, 4, 5, 7 }, { 0, 4, 6, 7 },
+};
+
+// cube [origin, origin + cells * step] on every axis, sampled at cells + 1 points per axis
+struct meshGrid
+{
+    int cells;
+    float origin;
+    float step;
+
+    int points() const { return cells + 1; };
+    glm::vec3 position(int x, int y, int z) const { return glm::vec3(origin + x * step, origin + y * step, origin + z * step); };
+};
+
+// triangles of the cell layers [z0, z1), vertices are numbered from 0 until the slab is written
+struct slabMesh
+{
+    std::vector<glm::vec3> vertices;
+    // three per triangle, a local vertex or -(edge key + 1) for a vertex on layer z0 that the slab below owns
+    std::vector<int64_t> triangles;
+    // edge key -> local vertex, the slab above resolves its references into layer z1 through it
+    std::unordered_map<uint64_t, uint32_t> edges;
+};
+
+static void printUsage()
+{
+    std::cout << "usage: meshExport [--resolution N] [--slab N] [--iterations N] [--epsilon E] [--c w,i,j,k]\n"
+                 "                  [--threads N] [--isa scalar|sse4|avx2|avx512] --out FILE.ply|FILE.obj\n";
+}
+
+static bool parseISA(const char* name, simdISA& isa)
+{
+    for (simdISA candidate : { simdISA::scalar, simdISA::sse4, simdISA::avx2, simdISA::avx512 })
+    {
+        if (strcmp(name, isaName(candidate)) == 0)
+        {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// distance bounds of the point layers z0..z1, one grid row per lane kernel call
+static void sampleSlab(const juliaFrame& frame, const meshGrid& grid, int z0, int z1, simdISA isa, std::vector<float>& field)
+{
+    const int n = grid.points();
+    std::vector<float> px(n), py(n), pz(n);
+    field.resize(static_cast<size_t>(z1 - z0 + 1) * n * n);
+
+    for (int z = z0; z <= z1; z++)
+    {
+        for (int y = 0; y < n; y++)
+        {
+            for (int x = 0; x < n; x++)
+            {
+                const glm::vec3 p = grid.position(x, y, z);
+                px[x] = p.x; py[x] = p.y; pz[x] = p.z;
+            }
+            distanceBoundLanes(frame, px.data(), py.data(), pz.data(), &field[(static_cast<size_t>(z - z0) * n + y) * n], n, isa);
+        }
+    }
+}
+
+static void polygoniseSlab(const meshGrid& grid, int z0, int z1, const std::vector<float>& field, float iso, slabMesh& mesh)
+{
+    const int n = grid.points();
+    mesh.vertices.clear();
+    mesh.triangles.clear();
+    mesh.edges.clear();
+
+    for (int z = z0; z < z1; z++)
+    {
+        for (int y = 0; y < grid.cells; y++)
+        {
+            for (int x = 0; x < grid.cells; x++)
+            {
+                // corner values relative to the iso level, inside is negative
+                float value[8];
+                int insideCount = 0;
+                for (int c = 0; c < 8; c++)
+                {
+                    const size_t index = (static_cast<size_t>(z + (c >> 2) - z0) * n + y + ((c >> 1) & 1)) * n + x + (c & 1);
+                    value[c] = field[index] - iso;
+                    insideCount += value[c] < 0.0f;
+                }
+                if (insideCount == 0 || insideCount == 8)
+                    continue;
+
+                // vertex on the edge between corners a and b, where a's bits are a subset of b's
+                auto edgeVertex = [&](int a, int b, glm::vec3& position) -> int64_t
+                {
+                    const int lx = x + (a & 1), ly = y + ((a >> 1) & 1), lz = z + (a >> 2);
+                    const int direction = a ^ b;
+                    const glm::vec3 pa = grid.position(lx, ly, lz);
+                    const glm::vec3 pb = grid.position(x + (b & 1), y + ((b >> 1) & 1), z + (b >> 2));
+                    position = pa + (pb - pa) * (value[a] / (value[a] - value[b]));
+
+                    const uint64_t key = ((static_cast<uint64_t>(lz) * n + ly) * n + lx) * 8 + direction;
+                    if (lz == z0 && z0 > 0 && !(direction & 4))
+                        return -static_cast<int64_t>(key) - 1;
+
+                    auto found = mesh.edges.find(key);
+                    if (found != mesh.edges.end())
+                        return found->second;
+                    const uint32_t local = static_cast<uint32_t>(mesh.vertices.size());
+                    mesh.vertices.push_back(position);
+                    mesh.edges.emplace(key, local);
+                    return local;
+                };
+
+                for (const int* tet : CELL_TETRAHEDRA)
+                {
+                    int inside[4], outside[4];
+                    int insideTet = 0, outsideTet = 0;
+                    for (int i = 0; i < 4; i++)
+                    {
+                        if (value[tet[i]] < 0.0f)
+                            inside[insideTet++] = i;
+                        else
+                            outside[outsideTet++] = i;
+                    }
+                    if (insideTet == 0 || outsideTet == 0)
+                        continue;
+
+                    // crossing edges in cycle order, a triangle around a lone corner or a quad between two pairs
+                    int cycle[4][2];
+                    int corners = 0;
+                    if (insideTet == 2)
+                    {
+                        const int a = inside[0], b = inside[1], c = outside[0], d = outside[1];
+                        const int quad[4][2] = { { a, c }, { a, d }, { b, d }, { b, c } };
+                        memcpy(cycle, quad, sizeof(quad));
+                        corners = 4;
+                    }
+                    else
+                    {
+                        const int lone = insideTet == 1 ? inside[0] : outside[0];
+                        for (int i = 0; i < 4; i++)
+                        {
+                            if (i != lone)
+                            {
+                                cycle[corners][0] = lone;
+                                cycle[corners][1] = i;
+                                corners++;
+                            }
+                        }
+                    }
+
+                    int64_t ref[4];
+                    glm::vec3 position[4];
+                    for (int i = 0; i < corners; i++)
+                    {
+                        const int a = std::min(cycle[i][0], cycle[i][1]);
+                        const int b = std::max(cycle[i][0], cycle[i][1]);
+                        ref[i] = edgeVertex(tet[a], tet[b], position[i]);
+                    }
+
+                    // wind counter-clockwise seen from outside, the side the positive corners are on
+                    glm::vec3 insideCentre(0.0f), outsideCentre(0.0f);
+                    for (int i = 0; i < 4; i++)
+                    {
+                        const glm::vec3 p = grid.position(x + (tet[i] & 1), y + ((tet[i] >> 1) & 1), z + (tet[i] >> 2));
+                        if (value[tet[i]] < 0.0f)
+                            insideCentre += p / float(insideTet);
+                        else
+                            outsideCentre += p / float(outsideTet);
+                    }
+                    const glm::vec3 normal = glm::cross(position[1] - position[0], position[2] - position[0]);
+                    const bool flip = glm::dot(normal, outsideCentre - insideCentre) < 0.0f;
+
+                    for (int t = 0; t < corners - 2; t++)
+                    {
+                        // fan around the first vertex, one triangle for three corners and two for four
+                        const int64_t tri[3] = { ref[0], ref[t + 1], ref[t + 2] };
+                        mesh.triangles.push_back(tri[0]);
+                        mesh.triangles.push_back(flip ? tri[2] : tri[1]);
+                        mesh.triangles.push_back(flip ? tri[1] : tri[2]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int resolution = 256;
+    int slab = 8;
+    int threads = 0;
+    simdISA isa = detectISA();
+    std::string outPath;
+    juliaSettings settings;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+
+        if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+        {
+            printUsage();
+            return 0;
+        }
+        if (!value)
+        {
+            std::cerr << "missing value for " << arg << std::endl;
+            printUsage();
+            return -1;
+        }
+        i++;
+
+        if (strcmp(arg, "--resolution") == 0) resolution = atoi(value);
+        else if (strcmp(arg, "--slab") == 0) slab = atoi(value);
+        else if (strcmp(arg, "--iterations") == 0) settings.maxIterations = atoi(value);
+        else if (strcmp(arg, "--epsilon") == 0) settings.epsilon = static_cast<float>(atof(value));
+        else if (strcmp(arg, "--threads") == 0) threads = std::max(0, atoi(value));
+        else if (strcmp(arg, "--out") == 0) outPath = value;
+        else if (strcmp(arg, "--c") == 0)
+        {
+            glm::vec4& c = settings.juliaConstant;
+            if (sscanf(value, "%f,%f,%f,%f", &c.x, &c.y, &c.z, &c.w) != 4)
+            {
+                std::cerr << "--c expects w,i,j,k" << std::endl;
+                return -1;
+            }
+        }
+        else if (strcmp(arg, "--isa") == 0)
+        {
+            if (!parseISA(value, isa))
+            {
+                std::cerr << "unknown isa " << value << std::endl;
+                return -1;
+            }
+        }
+        else
+        {
+            std::cerr << "unknown option " << arg << std::endl;
+            printUsage();
+            return -1;
+        }
+    }
+
+    if (outPath.empty() || resolution <= 0 || slab <= 0)
+    {
+        printUsage();
+        return -1;
+    }
+
+    if (isa > detectISA())
+    {
+        std::cerr << isaName(isa) << " is not supported on this cpu, using " << isaName(detectISA()) << std::endl;
+        isa = detectISA();
+    }
+
+    // the mesh is in the set's own frame, the iso level is an absolute distance whatever the renderers use
+    settings.epsilonMode = static_cast<int>(epsilonMethod::absolute);
+    juliaFrame frame;
+    frame.set = settings;
+
+    threadPool pool(static_cast<unsigned>(threads));
+    const auto start = std::chrono::steady_clock::now();
+
+    // absolute thresholds do not depend on a render height
+    const float radius = tightBoundingRadius(settings, pool, 0);
+    meshGrid grid;
+    grid.cells = resolution;
+    grid.origin = -radius;
+    grid.step = 2.0f * radius / resolution;
+
+    meshWriter writer;
+    if (!writer.open(outPath))
+        return -1;
+
+    std::cout << "polygonising " << resolution << "^3 cells inside radius " << radius << " on " << pool.size()
+              << " threads (" << isaName(isa) << "), " << slab << " layers per slab" << std::endl;
+
+    const int slabCount = (resolution + slab - 1) / slab;
+    const int batchSize = static_cast<int>(pool.size());
+    std::vector<slabMesh> batch(batchSize);
+    std::vector<std::vector<float>> fields(batchSize);
+    slabMesh previous;
+    uint64_t previousBase = 0;
+    std::vector<uint32_t> indices;
+
+    for (int first = 0; first < slabCount; first += batchSize)
+    {
+        const int count = std::min(batchSize, slabCount - first);
+        pool.parallelFor(count, [&](int i)
+        {
+            const int z0 = (first + i) * slab;
+            const int z1 = std::min(z0 + slab, resolution);
+            sampleSlab(frame, grid, z0, z1, isa, fields[i]);
+            polygoniseSlab(grid, z0, z1, fields[i], settings.epsilon, batch[i]);
+        });
+
+        // written in z order so every reference into a lower slab is already numbered
+        for (int i = 0; i < count; i++)
+        {
+            slabMesh& mesh = batch[i];
+            const uint64_t base = writer.vertexCount();
+            if (base + mesh.vertices.size() > 0x7FFFFFFFu)
+            {
+                std::cerr << "more than 2^31 vertices, ply indices are int32, try a lower --resolution" << std::endl;
+                writer.close();
+                return -1;
+            }
+
+            indices.resize(mesh.triangles.size());
+            for (size_t t = 0; t < mesh.triangles.size(); t++)
+            {
+                const int64_t ref = mesh.triangles[t];
+                if (ref >= 0)
+                {
+                    indices[t] = static_cast<uint32_t>(base + ref);
+                }
+                else
+                {
+                    // both slabs sampled this edge from the same two grid points, so the slab below has its vertex
+                    const uint64_t key = static_cast<uint64_t>(-(ref + 1));
+                    indices[t] = static_cast<uint32_t>(previousBase + previous.edges.at(key));
+                }
+            }
+
+            writer.writeVertices(mesh.vertices);
+            writer.writeTriangles(indices);
+            std::swap(previous, mesh);
+            previousBase = base;
+        }
+    }
+
+    if (!writer.close())
+    {
+        std::cerr << "failed to write " << outPath << std::endl;
+        return -1;
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    std::cout << "wrote " << outPath << ": " << writer.vertexCount() << " vertices, " << writer.triangleCount() << " triangles in "
+              << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "meshWriter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// element counts are written zero padded to this many digits so they can be overwritten once known
+static const int PLY_COUNT_DIGITS = 12;
+
+meshWriter::meshWriter()
+	: vertices(0), triangles(0), obj(false)
+{
+}
+
+meshWriter::~meshWriter()
+{
+	if (file.is_open())
+		close();
+}
+
+bool meshWriter::open(const std::string& outPath)
+{
+	path = outPath;
+	vertices = 0;
+	triangles = 0;
+
+	std::string extension = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	obj = extension == ".obj";
+
+	file.open(path, std::ios::binary);
+	if (!file)
+	{
+		std::cerr << "failed to open " << path << " for writing" << std::endl;
+		return false;
+	}
+
+	if (obj)
+		return true;
+
+	facePath = path + ".faces";
+	faceFile.open(facePath, std::ios::binary);
+	if (!faceFile)
+	{
+		std::cerr << "failed to open " << facePath << " for writing" << std::endl;
+		file.close();
+		return false;
+	}
+
+	char counts[64];
+	snprintf(counts, sizeof(counts), "%0*d", PLY_COUNT_DIGITS, 0);
+	file << "ply\nformat binary_little_endian 1.0\ncomment quaternion julia set\nelement vertex ";
+	vertexCountPos = file.tellp();
+	file << counts << "\nproperty float x\nproperty float y\nproperty float z\nelement face ";
+	faceCountPos = file.tellp();
+	file << counts << "\nproperty list uchar int vertex_indices\nend_header\n";
+	return file.good();
+}
+
+void meshWriter::writeVertices(const std::vector<glm::vec3>& batch)
+{
+	if (obj)
+	{
+		buffer.clear();
+		char line[96];
+		for (const glm::vec3& v : batch)
+		{
+			const int length = snprintf(line, sizeof(line), "v %.7g %.7g %.7g\n", v.x, v.y, v.z);
+			buffer.insert(buffer.end(), line, line + length);
+		}
+		file.write(buffer.data(), buffer.size());
+	}
+	else
+	{
+		// glm::vec3 is three packed floats and the header says little endian, same as every target we build for
+		file.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(glm::vec3));
+	}
+	vertices += batch.size();
+}
+
+void meshWriter::writeTriangles(const std::vector<uint32_t>& indices)
+{
+	const size_t count = indices.size() / 3;
+	buffer.clear();
+	if (obj)
+	{
+		char line[96];
+		for (size_t i = 0; i < count; i++)
+		{
+			// obj indices start at 1
+			const int length = snprintf(line, sizeof(line), "f %u %u %u\n", indices[i * 3] + 1, indices[i * 3 + 1] + 1, indices[i * 3 + 2] + 1);
+			buffer.insert(buffer.end(), line, line + length);
+		}
+		file.write(buffer.data(), buffer.size());
+	}
+	else
+	{
+		// uchar 3 followed by three int32 per face
+		buffer.resize(count * 13);
+		char* out = buffer.data();
+		for (size_t i = 0; i < count; i++)
+		{
+			*out++ = 3;
+			memcpy(out, &indices[i * 3], 12);
+			out += 12;
+		}
+		faceFile.write(buffer.data(), buffer.size());
+	}
+	triangles += count;
+}
+
+bool meshWriter::close()
+{
+	if (!file.is_open())
+		return false;
+
+	bool ok = true;
+	if (!obj)
+	{
+		// append the faces and fill in the counts the header left room for
+		ok = faceFile.good();
+		faceFile.close();
+		if (triangles > 0)
+		{
+			// inserting an empty stream buffer would set failbit, so only copy when there is something to copy
+			std::ifstream faces(facePath, std::ios::binary);
+			if (faces)
+				file << faces.rdbuf();
+			else
+				ok = false;
+		}
+		std::remove(facePath.c_str());
+
+		char counts[64];
+		snprintf(counts, sizeof(counts), "%0*llu", PLY_COUNT_DIGITS, static_cast<unsigned long long>(vertices));
+		file.seekp(vertexCountPos);
+		file << counts;
+		snprintf(counts, sizeof(counts), "%0*llu", PLY_COUNT_DIGITS, static_cast<unsigned long long>(triangles));
+		file.seekp(faceCountPos);
+		file << counts;
+	}
+
+	ok = ok && file.good();
+	file.close();
+	return ok;
+}
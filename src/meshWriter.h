@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// triangle mesh written out as it is produced, nothing but the current batch is kept in memory
+// vertices are numbered from 0 in the order they are written, triangles may use any vertex written before them
+//
+// OBJ takes vertices and faces interleaved, so it streams straight into the file
+// binary PLY needs every vertex ahead of the first face, faces go to a side file that is appended on close
+// and the element counts in the header are patched in place
+class meshWriter
+{
+public:
+	meshWriter();
+	~meshWriter();
+
+	meshWriter(const meshWriter&) = delete;
+	meshWriter& operator=(const meshWriter&) = delete;
+
+	// picks the format from the file extension, .obj or anything else as binary little endian ply
+	bool open(const std::string& path);
+
+	void writeVertices(const std::vector<glm::vec3>& vertices);
+	// three indices per triangle, counter-clockwise seen from outside
+	void writeTriangles(const std::vector<uint32_t>& indices);
+
+	// finishes the file, returns false if anything failed to write
+	bool close();
+
+	uint64_t vertexCount() const { return vertices; };
+	uint64_t triangleCount() const { return triangles; };
+private:
+	std::string path;
+	std::string facePath;   // ply only
+	std::ofstream file;
+	std::ofstream faceFile;
+	std::streampos vertexCountPos;  // where the padded element counts sit in the ply header
+	std::streampos faceCountPos;
+	std::vector<char> buffer;
+	uint64_t vertices;
+	uint64_t triangles;
+	bool obj;
+};
@@ -0,0 +1,171 @@
+#include "perfOverlay.h"
+
+#include <imGui/imgui.h>
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+
+static const char* passNames[] = { "fractal", "ui" };
+static_assert(sizeof(passNames) / sizeof(passNames[0]) == static_cast<int>(perfPass::count), "passNames out of sync with perfPass");
+
+perfOverlay::perfOverlay()
+	: recording(false), history(HISTORY), plotCpu(HISTORY, 0.0f), plotFractal(HISTORY, 0.0f), historyPos(0)
+{
+	for (perfSample& s : history)
+		s.frame = -1;
+}
+
+void perfOverlay::beginFrame(long long frame, float cpuMs, int renderWidth, int renderHeight, const juliaSettings& set)
+{
+	perfSample s;
+	s.frame = frame;
+	s.cpuMs = cpuMs;
+	for (float& ms : s.gpuMs)
+		ms = -1.0f;
+	s.width = renderWidth;
+	s.height = renderHeight;
+	s.aaSamples = set.aaSamples;
+	s.maxIterations = set.maxIterations;
+	s.epsilon = set.epsilon;
+	s.exhaustedRays = -1;
+
+	const int index = static_cast<int>(frame % HISTORY);
+	history[index] = s;
+	plotCpu[index] = cpuMs;
+	plotFractal[index] = 0.0f;
+	historyPos = (index + 1) % HISTORY;
+
+	if (recording)
+		recorded.push_back(s);
+}
+
+perfSample* perfOverlay::findSample(std::vector<perfSample>& samples, long long frame)
+{
+	// results come back a few frames late, so only look at the newest entries
+	const size_t searchDepth = std::min<size_t>(samples.size(), 16);
+	for (size_t i = 0; i < searchDepth; i++)
+	{
+		perfSample& s = samples[samples.size() - 1 - i];
+		if (s.frame == frame)
+			return &s;
+	}
+	return nullptr;
+}
+
+void perfOverlay::setGpuTime(perfPass pass, long long frame, float ms)
+{
+	const int index = static_cast<int>(frame % HISTORY);
+	if (history[index].frame == frame)
+	{
+		history[index].gpuMs[static_cast<int>(pass)] = ms;
+		if (pass == perfPass::fractal)
+			plotFractal[index] = ms;
+	}
+
+	if (perfSample* s = findSample(recorded, frame))
+		s->gpuMs[static_cast<int>(pass)] = ms;
+}
+
+void perfOverlay::setExhaustedRays(long long frame, unsigned int count)
+{
+	const int index = static_cast<int>(frame % HISTORY);
+	if (history[index].frame == frame)
+		history[index].exhaustedRays = count;
+
+	if (perfSample* s = findSample(recorded, frame))
+		s->exhaustedRays = count;
+}
+
+void perfOverlay::draw()
+{
+	ImGui::SetNextWindowSize(ImVec2(560, 420), ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowPos(ImVec2(690, 20), ImGuiCond_FirstUseEver);
+
+	ImGui::Begin("Performance");
+
+	// average over the frames that already have their GPU results
+	float cpuSum = 0.0f, cpuMax = 0.0f, fractalMax = 0.0f;
+	long long exhaustedMax = 0;
+	float gpuSum[static_cast<int>(perfPass::count)] = {};
+	int cpuCount = 0, gpuCount[static_cast<int>(perfPass::count)] = {};
+	for (const perfSample& s : history)
+	{
+		if (s.frame < 0)
+			continue;
+		cpuSum += s.cpuMs;
+		cpuMax = std::max(cpuMax, s.cpuMs);
+		cpuCount++;
+		for (int p = 0; p < static_cast<int>(perfPass::count); p++)
+		{
+			if (s.gpuMs[p] >= 0.0f)
+			{
+				gpuSum[p] += s.gpuMs[p];
+				gpuCount[p]++;
+			}
+		}
+		fractalMax = std::max(fractalMax, s.gpuMs[static_cast<int>(perfPass::fractal)]);
+		exhaustedMax = std::max(exhaustedMax, s.exhaustedRays);
+	}
+
+	const float cpuAvg = cpuCount ? cpuSum / cpuCount : 0.0f;
+	ImGui::Text("CPU frame   %6.2f ms  (%5.1f fps)", cpuAvg, cpuAvg > 0.0f ? 1000.0f / cpuAvg : 0.0f);
+	for (int p = 0; p < static_cast<int>(perfPass::count); p++)
+		ImGui::Text("GPU %-8s%6.2f ms", passNames[p], gpuCount[p] ? gpuSum[p] / gpuCount[p] : 0.0f);
+	// rays that hit the step budget are drawn as misses, a growing count means maxMarchSteps is too tight
+	ImGui::Text("Exhausted rays (max) %lld", exhaustedMax);
+
+	ImGui::PlotLines("CPU (ms)", plotCpu.data(), HISTORY, historyPos, nullptr, 0.0f, std::max(cpuMax, 1.0f), ImVec2(0, 80));
+	ImGui::PlotLines("Fractal (ms)", plotFractal.data(), HISTORY, historyPos, nullptr, 0.0f, std::max(fractalMax, 1.0f), ImVec2(0, 80));
+
+	ImGui::Separator();
+	ImGui::Checkbox("Record", &recording);
+	ImGui::SameLine();
+	ImGui::Text("%d samples", static_cast<int>(recorded.size()));
+	if (ImGui::Button("Export CSV"))
+	{
+		char name[64];
+		std::time_t now = std::time(nullptr);
+		std::strftime(name, sizeof(name), "perf_%Y%m%d_%H%M%S.csv", std::localtime(&now));
+		status = exportCSV(name) ? std::string("wrote ") + name : std::string("failed to write ") + name;
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Clear"))
+	{
+		recorded.clear();
+		status.clear();
+	}
+	if (!status.empty())
+		ImGui::TextUnformatted(status.c_str());
+
+	ImGui::End();
+}
+
+bool perfOverlay::exportCSV(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+		return false;
+
+	file << "frame,cpu_ms";
+	for (const char* name : passNames)
+		file << ",gpu_" << name << "_ms";
+	file << ",width,height,aa_samples,max_iterations,epsilon,exhausted_rays\n";
+
+	for (const perfSample& s : recorded)
+	{
+		file << s.frame << "," << s.cpuMs;
+		for (float ms : s.gpuMs)
+		{
+			file << ",";
+			if (ms >= 0.0f)
+				file << ms;
+		}
+		file << "," << s.width << "," << s.height << "," << s.aaSamples << "," << s.maxIterations << "," << s.epsilon << ",";
+		if (s.exhaustedRays >= 0)
+			file << s.exhaustedRays;
+		file << "\n";
+	}
+
+	return file.good();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "juliaSettings.h"
+
+#include <string>
+#include <vector>
+
+// GPU passes that are timed every frame
+enum class perfPass
+{
+	fractal,
+	ui,
+	count
+};
+
+struct perfSample
+{
+	long long frame;
+	float cpuMs;
+	float gpuMs[static_cast<int>(perfPass::count)];   // < 0 until the query result comes back
+	int width;
+	int height;
+	int aaSamples;
+	int maxIterations;
+	float epsilon;
+	long long exhaustedRays;    // < 0 until the count comes back
+};
+
+// per-frame timings shown in an ImGui window next to the shader controls
+// samples can be recorded and exported as CSV for tuning sessions
+class perfOverlay
+{
+public:
+	perfOverlay();
+
+	void beginFrame(long long frame, float cpuMs, int renderWidth, int renderHeight, const juliaSettings& set);
+	void setGpuTime(perfPass pass, long long frame, float ms);
+	void setExhaustedRays(long long frame, unsigned int count);
+
+	void draw();
+	bool exportCSV(const std::string& path) const;
+
+	bool recording;
+private:
+	perfSample* findSample(std::vector<perfSample>& samples, long long frame);
+
+	static const int HISTORY = 240;
+	std::vector<perfSample> history;      // ring of the last HISTORY frames
+	std::vector<perfSample> recorded;     // everything since recording started
+	std::vector<float> plotCpu;
+	std::vector<float> plotFractal;
+	int historyPos;
+	std::string status;
+};
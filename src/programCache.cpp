@@ -0,0 +1,147 @@
+#include "programCache.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+static const uint32_t CACHE_MAGIC = 0x4A504243; // "JPBC"
+// linked binaries are kilobytes to a few megabytes, a larger length can only come from a corrupt header
+static const uint32_t MAX_BINARY_LENGTH = 64u * 1024u * 1024u;
+
+struct cacheHeader
+{
+    uint32_t magic;
+    uint32_t format;
+    uint32_t length;
+};
+
+static uint64_t hashBytes(uint64_t hash, const std::string& bytes)
+{
+    // FNV-1a, with a separator so ("ab", "c") and ("a", "bc") differ
+    for (unsigned char c : bytes)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    hash ^= 0xFF;
+    hash *= 1099511628211ull;
+    return hash;
+}
+
+static std::string glString(GLenum name)
+{
+    const GLubyte* str = glGetString(name);
+    return str ? std::string(reinterpret_cast<const char*>(str)) : std::string();
+}
+
+static bool binaryCacheSupported()
+{
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+std::string programCacheKey(const std::vector<std::string>& sources, const std::string& defines)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (const std::string& source : sources)
+        hash = hashBytes(hash, source);
+    hash = hashBytes(hash, defines);
+    hash = hashBytes(hash, glString(GL_VENDOR));
+    hash = hashBytes(hash, glString(GL_RENDERER));
+    hash = hashBytes(hash, glString(GL_VERSION));
+
+    std::ostringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return key.str();
+}
+
+unsigned int loadCachedProgram(const std::string& key)
+{
+    if (!binaryCacheSupported())
+        return 0;
+
+    const std::string path = programCachePath + key + ".bin";
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return 0;
+
+    cacheHeader header = {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    // the length has to match what is actually left in the file before it sizes anything
+    bool lengthValid = false;
+    if (file && header.magic == CACHE_MAGIC && header.length > 0 && header.length <= MAX_BINARY_LENGTH)
+    {
+        const std::streampos binaryStart = file.tellg();
+        file.seekg(0, std::ios::end);
+        const std::streamoff remaining = file.tellg() - binaryStart;
+        file.seekg(binaryStart);
+        lengthValid = file && remaining == static_cast<std::streamoff>(header.length);
+    }
+
+    std::vector<char> binary(lengthValid ? header.length : 0);
+    if (!binary.empty())
+        file.read(binary.data(), binary.size());
+
+    if (!file || !lengthValid)
+    {
+        file.close();
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    // drivers may reject binaries from an older build, fall back to compiling
+    int success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glDeleteProgram(program);
+        file.close();
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return 0;
+    }
+
+    return program;
+}
+
+void storeCachedProgram(const std::string& key, unsigned int program)
+{
+    if (!program || !binaryCacheSupported())
+        return;
+
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    std::error_code ec;
+    std::filesystem::create_directories(programCachePath, ec);
+
+    // write to a temp file and rename so a crash never leaves a truncated entry
+    const std::string path = programCachePath + key + ".bin";
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return;
+
+        cacheHeader header = { CACHE_MAGIC, format, static_cast<uint32_t>(length) };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), length);
+        if (!file)
+            return;
+    }
+    std::filesystem::rename(tempPath, path, ec);
+}
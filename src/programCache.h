@@ -0,0 +1,18 @@
+#pragma once
+
+#include "common.h"
+
+// on-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary)
+// entries are keyed by the shader sources, the driver vendor/renderer/version strings and the injected defines,
+// so a driver update or an edited shader simply misses and recompiles
+
+static const std::string programCachePath = "shaderCache/";
+
+// hex key for the given sources and defines on the current context's driver
+std::string programCacheKey(const std::vector<std::string>& sources, const std::string& defines);
+
+// returns a linked program or 0 when there is no usable entry, rejected binaries are deleted silently
+unsigned int loadCachedProgram(const std::string& key);
+
+// stores the binary of a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+void storeCachedProgram(const std::string& key, unsigned int program);
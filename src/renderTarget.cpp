@@ -0,0 +1,69 @@
+#include "renderTarget.h"
+
+#include <algorithm>
+
+renderTarget::renderTarget(const std::vector<GLenum>& internalFormats, GLenum textureFilter)
+    : FBO_ID(0), textures(internalFormats.size(), 0), formats(internalFormats), filter(textureFilter), w(0), h(0)
+{
+    glGenFramebuffers(1, &FBO_ID);
+}
+
+renderTarget::~renderTarget()
+{
+    if (!textures.empty() && textures[0])
+        glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
+    if (FBO_ID)
+        glDeleteFramebuffers(1, &FBO_ID);
+}
+
+bool renderTarget::resize(int width, int height)
+{
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (width == w && height == h)
+        return false;
+
+    w = width;
+    h = height;
+
+    // immutable storage cannot be resized, so start over
+    if (textures[0])
+        glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
+    glGenTextures(static_cast<GLsizei>(textures.size()), textures.data());
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO_ID);
+
+    std::vector<GLenum> drawBuffers;
+    for (size_t i = 0; i < textures.size(); i++)
+    {
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexStorage2D(GL_TEXTURE_2D, 1, formats[i], w, h);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i), GL_TEXTURE_2D, textures[i], 0);
+        drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i));
+    }
+    glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "render target " << w << "x" << h << " is incomplete" << std::endl;
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
+
+void renderTarget::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO_ID);
+    glViewport(0, 0, w, h);
+}
+
+void renderTarget::bindDefault(int width, int height)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+}
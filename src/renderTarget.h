@@ -0,0 +1,32 @@
+#pragma once
+
+#include "common.h"
+
+// offscreen framebuffer with one float texture per colour attachment
+class renderTarget
+{
+public:
+	renderTarget(const std::vector<GLenum>& internalFormats, GLenum textureFilter = GL_NEAREST);
+	~renderTarget();
+
+	renderTarget(const renderTarget&) = delete;
+	renderTarget& operator=(const renderTarget&) = delete;
+
+	// reallocates the attachments when the size changes, contents are undefined afterwards
+	// returns true if anything was reallocated
+	bool resize(int w, int h);
+
+	void bind() const;                  // binds the fbo and sets the viewport to its size
+	static void bindDefault(int w, int h);
+
+	unsigned int texture(int attachment) const { return textures[attachment]; };
+	int width() const { return w; };
+	int height() const { return h; };
+private:
+	unsigned int FBO_ID;
+	std::vector<unsigned int> textures;
+	std::vector<GLenum> formats;
+	GLenum filter;
+	int w;
+	int h;
+};
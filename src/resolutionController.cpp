@@ -0,0 +1,52 @@
+#include "resolutionController.h"
+
+#include <algorithm>
+#include <cmath>
+
+// scale changes reallocate the render target, so only move in coarse steps
+// corrections smaller than a step add up until they are worth one instead of being rounded away
+static const float SCALE_STEP = 0.05f;
+
+resolutionController::resolutionController(float budgetMs)
+    : targetMs(budgetMs), minScale(0.25f), maxScale(1.0f), current(1.0f), pending(1.0f), smoothedMs(0.0f)
+{
+}
+
+void resolutionController::reset()
+{
+    current = maxScale;
+    pending = maxScale;
+    smoothedMs = 0.0f;
+}
+
+void resolutionController::update(float frameMs)
+{
+    if (frameMs <= 0.0f)
+        return;
+
+    // smooth out single slow frames (shader recompiles, window events)
+    smoothedMs = (smoothedMs > 0.0f) ? smoothedMs + (frameMs - smoothedMs) * 0.2f : frameMs;
+
+    // dead band so the scale does not flicker around the budget
+    const float ratio = targetMs / smoothedMs;
+    if (ratio > 0.9f && ratio < 1.1f)
+        return;
+
+    // step at most 15% down or 10% up per adjustment, but never less than a whole step
+    // at low scales 10% is smaller than a step and the scale could never move up
+    pending = pending * std::sqrt(ratio);
+    pending = std::min(std::max(pending, std::min(current * 0.85f, current - SCALE_STEP)), std::max(current * 1.1f, current + SCALE_STEP));
+    pending = std::min(std::max(pending, minScale), maxScale);
+    if (std::fabs(pending - current) < SCALE_STEP * 0.999f)
+        return;
+
+    // at least one whole step towards pending, rounding could otherwise land back on current
+    float desired = std::round(pending / SCALE_STEP) * SCALE_STEP;
+    if (std::fabs(desired - current) < SCALE_STEP * 0.5f)
+        desired = current + (pending > current ? SCALE_STEP : -SCALE_STEP);
+    desired = std::min(std::max(desired, minScale), maxScale);
+
+    // predict the time at the new scale so the smoothing does not overshoot
+    smoothedMs *= (desired * desired) / (current * current);
+    current = desired;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+// picks the offscreen render scale that keeps the measured frame time on a budget
+// cost is roughly proportional to pixel count, so the scale moves with sqrt(budget / time)
+class resolutionController
+{
+public:
+	explicit resolutionController(float budgetMs = 16.6f);
+
+	// feed the time of a frame that was rendered at scale()
+	void update(float frameMs);
+	void reset();
+
+	float scale() const { return current; };
+
+	float targetMs;
+	float minScale;
+	float maxScale;
+private:
+	float current;
+	float pending;      // unrounded scale the corrections add up in, current follows it in whole steps
+	float smoothedMs;
+};
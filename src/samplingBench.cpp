@@ -0,0 +1,147 @@
+// image error against a reference as a function of sample count, once per sample pattern
+// the reference is rendered once with many hash jittered samples taken from far past the indices any case uses,
+// so no pattern's image is a prefix of the reference, every case then renders the same view through cpuRenderer
+// and reports the RMSE and largest pixel error next to the render time, so patterns can be compared at equal error
+//
+// usage: samplingBench [--width N] [--height N] [--reference N] [--max N] [--threads N] [--out results.json]
+
+#include "cpuRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// first sample index of the reference, above every sample count a case renders
+static const int REFERENCE_SAMPLE_OFFSET = 1 << 16;
+
+struct samplingResult
+{
+	std::string pattern;
+	int samples;
+	double rmse;
+	double maxError;    // largest channel difference to the reference
+	double ms;
+};
+
+static void compare(const std::vector<glm::vec3>& image, const std::vector<glm::vec3>& reference, double& rmse, double& maxError)
+{
+	double sum = 0.0;
+	maxError = 0.0;
+	for (size_t i = 0; i < image.size(); i++)
+	{
+		const glm::vec3 d = image[i] - reference[i];
+		sum += d.x * d.x + d.y * d.y + d.z * d.z;
+		maxError = std::max(maxError, static_cast<double>(std::max(std::fabs(d.x), std::max(std::fabs(d.y), std::fabs(d.z)))));
+	}
+	rmse = std::sqrt(sum / (3.0 * image.size()));
+}
+
+static std::string toJSON(const std::vector<samplingResult>& results, int width, int height, int referenceSamples)
+{
+	std::ostringstream out;
+	out << "{\n  \"width\": " << width << ",\n  \"height\": " << height << ",\n  \"referenceSamples\": " << referenceSamples
+		<< ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const samplingResult& r = results[i];
+		out << "    { \"pattern\": \"" << r.pattern << "\""
+			<< ", \"samples\": " << r.samples
+			<< ", \"rmse\": " << r.rmse
+			<< ", \"max_error\": " << r.maxError
+			<< ", \"ms\": " << r.ms
+			<< " }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}\n";
+	return out.str();
+}
+
+int main(int argc, char** argv)
+{
+	int width = 480;
+	int height = 270;
+	int referenceSamples = 2048;   // hash jitter converges slower than the sequences it is compared against
+	int maxSamples = 64;
+	int threads = 0;
+	std::string outPath;
+
+	const char* usage = "usage: samplingBench [--width N] [--height N] [--reference N] [--max N] [--threads N] [--out results.json]";
+	for (int i = 1; i < argc; i++)
+	{
+		const char* arg = argv[i];
+		const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+		if (!value)
+		{
+			std::cerr << "missing value for " << arg << std::endl;
+			std::cerr << usage << std::endl;
+			return -1;
+		}
+		i++;
+
+		if (strcmp(arg, "--width") == 0) width = std::max(1, atoi(value));
+		else if (strcmp(arg, "--height") == 0) height = std::max(1, atoi(value));
+		else if (strcmp(arg, "--reference") == 0) referenceSamples = std::max(1, atoi(value));
+		else if (strcmp(arg, "--max") == 0) maxSamples = std::min(std::max(1, atoi(value)), REFERENCE_SAMPLE_OFFSET);
+		else if (strcmp(arg, "--threads") == 0) threads = std::max(0, atoi(value));
+		else if (strcmp(arg, "--out") == 0) outPath = value;
+		else
+		{
+			std::cerr << usage << std::endl;
+			return -1;
+		}
+	}
+
+	camera cam(static_cast<float>(width), static_cast<float>(height));
+	cpuRenderer renderer(static_cast<unsigned>(threads));
+
+	juliaSettings set;
+	set.samplePattern = static_cast<int>(sampleSequence::hash);
+	set.aaSamples = referenceSamples;
+	std::vector<glm::vec3> reference;
+	renderer.sampleOffset = REFERENCE_SAMPLE_OFFSET;
+	renderer.render(set, cam, reference);
+	renderer.sampleOffset = 0;
+	std::cerr << "reference with " << referenceSamples << " samples done" << std::endl;
+
+	std::vector<samplingResult> results;
+	std::vector<glm::vec3> image;
+	for (int pattern = 0; pattern < static_cast<int>(sampleSequence::count); pattern++)
+	{
+		for (int samples = 1; samples <= maxSamples; samples *= 2)
+		{
+			set.samplePattern = pattern;
+			set.aaSamples = samples;
+
+			auto start = std::chrono::steady_clock::now();
+			renderer.render(set, cam, image);
+			auto end = std::chrono::steady_clock::now();
+
+			samplingResult r = { sampleSequenceNames[pattern], samples, 0.0, 0.0, std::chrono::duration<double, std::milli>(end - start).count() };
+			compare(image, reference, r.rmse, r.maxError);
+			results.push_back(r);
+		}
+		std::cerr << sampleSequenceNames[pattern] << " done" << std::endl;
+	}
+
+	const std::string json = toJSON(results, width, height, referenceSamples);
+	if (outPath.empty())
+	{
+		std::cout << json;
+	}
+	else
+	{
+		std::ofstream file(outPath);
+		if (!file)
+		{
+			std::cerr << "failed to open " << outPath << std::endl;
+			return -1;
+		}
+		file << json;
+	}
+
+	return 0;
+}
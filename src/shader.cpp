@@ -1,4 +1,5 @@
 #include "shader.h"
+#include "programCache.h"
 
 #include <filesystem>
 #include <algorithm>
@@ -6,11 +7,20 @@
 #include <sstream>
 #include <glm/gtc/type_ptr.hpp>
 
-static std::string ParseShader(const std::string file)
+// #include "file" lines are replaced by the named file, resolved next to the including one
+static const int MAX_INCLUDE_DEPTH = 8;
+
+static std::string ParseShader(const std::string file, int depth = 0)
 {
     if (file.empty())
         return file;
 
+    if (depth > MAX_INCLUDE_DEPTH)
+    {
+        std::cerr << "shader includes nested too deep at " << file << std::endl;
+        return std::string();
+    }
+
     std::string shaderText;
     std::string line;
 
@@ -24,9 +34,32 @@ static std::string ParseShader(const std::string file)
     {
         std::getline(fileStream, line);
 
-        // read in shader
-        shaderText.append(line);
-        shaderText.append("\n");
+        size_t directive = line.find_first_not_of(" \t");
+        if (directive != std::string::npos && line.compare(directive, 8, "#include") == 0)
+        {
+            size_t open = line.find('"', directive);
+            size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+            if (close == std::string::npos)
+            {
+                std::cerr << "malformed include in " << file << ": " << line << std::endl;
+                return std::string();
+            }
+
+            std::filesystem::path includePath = std::filesystem::path(file).parent_path() / line.substr(open + 1, close - open - 1);
+            std::string included = ParseShader(includePath.string(), depth + 1);
+            if (included.empty())
+            {
+                std::cerr << "failed to include " << includePath.string() << " from " << file << std::endl;
+                return std::string();
+            }
+            shaderText.append(included);
+        }
+        else
+        {
+            // read in shader
+            shaderText.append(line);
+            shaderText.append("\n");
+        }
 
         if (fileStream.eof())
             break;
@@ -40,12 +73,34 @@ static std::string ParseShader(const std::string file)
     return shaderText;
 }
 
+// #define lines have to follow #version, which must stay the first line
+static std::string injectDefines(const std::string& source, const std::string& defineBlock)
+{
+    if (defineBlock.empty() || source.empty())
+        return source;
+
+    size_t insertAt = 0;
+    if (source.compare(0, 8, "#version") == 0)
+    {
+        insertAt = source.find('\n');
+        insertAt = insertAt == std::string::npos ? source.size() : insertAt + 1;
+    }
+    return source.substr(0, insertAt) + defineBlock + source.substr(insertAt);
+}
+
+std::string shader::defineLines(const shaderDefines& defines)
+{
+    std::string lines;
+    for (const auto& define : defines)
+        lines += "#define " + define.first + " " + define.second + "\n";
+    return lines;
+}
 
 void shader::loadVertFrag(const std::string& vertFile, const std::string& fragFile)
 {
     if (!vertFile.empty())
     {
-        shaderSourceCode.vertexShader = ParseShader(vertFile);
+        shaderSourceCode.vertexShader = injectDefines(ParseShader(vertFile), defineBlock);
         if (shaderSourceCode.vertexShader.empty())
         {
             std::cerr << "error reading vertex  shader" << std::endl;
@@ -60,7 +115,7 @@ void shader::loadVertFrag(const std::string& vertFile, const std::string& fragFi
 
     if (!fragFile.empty())
     {
-        shaderSourceCode.fragShader = ParseShader(fragFile);
+        shaderSourceCode.fragShader = injectDefines(ParseShader(fragFile), defineBlock);
         if (shaderSourceCode.fragShader.empty())
         { 
             std::cerr << "error reading fragment shader  " << std::endl;
@@ -78,6 +133,7 @@ void shader::loadVertFrag(const std::string& vertFile, const std::string& fragFi
     if (VF_ProgID)
     {
         std::cout << "Vertex & Fragment program created with ID " << VF_ProgID << std::endl;
+        cacheUniformLocations(VF_ProgID, fragSourceFile);
     }
     else
     {
@@ -90,7 +146,7 @@ void shader::loadCompute(const std::string& compFile)
 {
     if (!compFile.empty())
     {
-        shaderSourceCode.computeShader = ParseShader(compFile);
+        shaderSourceCode.computeShader = injectDefines(ParseShader(compFile), defineBlock);
         if (shaderSourceCode.computeShader.empty())
         {
             std::cerr << "Failed to read compute file: " << compFile << "\n";
@@ -108,6 +164,7 @@ void shader::loadCompute(const std::string& compFile)
     if (Comp_ProgID)
     {
         std::cout << "Compute program created with ID " << Comp_ProgID << std::endl;
+        cacheUniformLocations(Comp_ProgID, compFile);
     }
     else
     {
@@ -139,21 +196,39 @@ void shader::unbindVF() const
     glUseProgram(0);
 }
 
-bool shader::settingsChanged()
+unsigned int shader::namedProgram() const
+{
+    return VF_ProgID ? VF_ProgID : Comp_ProgID;
+}
+
+unsigned int shader::getComp_ID() const
+{
+    return Comp_ProgID;
+}
+
+void shader::bindComp() const
+{
+    glUseProgram(Comp_ProgID);
+}
+
+void shader::dispatchCompute(int width, int height) const
+{
+    const GLuint groupsX = static_cast<GLuint>((width + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE);
+    const GLuint groupsY = static_cast<GLuint>((height + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE);
+    glDispatchCompute(groupsX, groupsY, 1);
+}
+
+unsigned shader::settingsChanged()
 {
-    bool update = memcmp(&currSet, &prevSet, sizeof(juliaSettings)) != 0;
-    if (update)
+    unsigned changed = changedFields(currSet, prevSet);
+    if (changed)
         prevSet = currSet;
-    return update;
+    return changed;
 }
 
-void shader::updateSettings() const
+void shader::updateSettings(juliaParams* pParams) const
 {
-    setUniformV4("juliaConstant", currSet.juliaConstant);
-    setUniform1i("maxSteps", currSet.maxIterations);
-    setUniform1f("EPSILON", currSet.epsilon);
-    setUniform1i("AASAMPLES", currSet.aaSamples);
-    setUniform1f("fov", currSet.fov);
+    pParams->setSettings(currSet);
 
 }
 
@@ -197,6 +272,7 @@ static unsigned int LinkProgramVF(unsigned vertShader, unsigned fragShader)
     if (vertShader) glAttachShader(program, vertShader);
     if (fragShader) glAttachShader(program, fragShader);
 
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
 
     int success;
@@ -225,6 +301,7 @@ static unsigned int LinkProgramComp(unsigned computeShader)
 
     if (computeShader) glAttachShader(program, computeShader);
 
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
 
     int success;
@@ -248,6 +325,12 @@ static unsigned int LinkProgramComp(unsigned computeShader)
 
 unsigned int shader::createVFProgram()
 {
+    // skip compile & link entirely when the driver accepts a cached binary
+    const std::string cacheKey = programCacheKey({ shaderSourceCode.vertexShader, shaderSourceCode.fragShader }, defineBlock);
+    unsigned int program = loadCachedProgram(cacheKey);
+    if (program)
+        return program;
+
     unsigned int vert = 0, frag = 0, comp = 0;
 
     if (!shaderSourceCode.vertexShader.empty())
@@ -255,21 +338,94 @@ unsigned int shader::createVFProgram()
     if (!shaderSourceCode.fragShader.empty())
         frag = CreateShader(GL_FRAGMENT_SHADER, shaderSourceCode.fragShader, fragSourceFile);
 
-    return LinkProgramVF(vert, frag);
+    program = LinkProgramVF(vert, frag);
+    storeCachedProgram(cacheKey, program);
+    return program;
 }
 
 unsigned int shader::createCompProgram()
 {
+    const std::string cacheKey = programCacheKey({ shaderSourceCode.computeShader }, defineBlock);
+    unsigned int program = loadCachedProgram(cacheKey);
+    if (program)
+        return program;
+
     unsigned int comp = 0;
     if (!shaderSourceCode.computeShader.empty())
         comp = CreateShader(GL_COMPUTE_SHADER, shaderSourceCode.computeShader, computeSourceFile);
-    return LinkProgramComp(comp);
+
+    program = LinkProgramComp(comp);
+    storeCachedProgram(cacheKey, program);
+    return program;
+}
+
+// names must match the order of uniformID
+static const std::array<const char*, static_cast<size_t>(uniformID::count)> uniformNames =
+{{
+    "sampleOffset",
+    "useReprojection",
+}};
+
+void shader::cacheUniformLocations(unsigned int program, const std::string& sourceFile)
+{
+    // the parameter block is shared by every program through a fixed binding point
+    unsigned int blockIndex = glGetUniformBlockIndex(program, "juliaParams");
+    if (blockIndex != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, blockIndex, JULIA_PARAMS_BINDING);
+
+    int found = 0;
+    for (int i = 0; i < static_cast<int>(uniformID::count); i++)
+    {
+        uniformLocations[i] = glGetUniformLocation(program, uniformNames[i]);
+        if (uniformLocations[i] != -1)
+            found++;
+    }
+
+    // programs that use none of the julia uniforms (e.g. blit passes) have nothing to report
+    if (found == 0)
+        return;
+
+    // report once here, setting a missing uniform later is a silent no-op (location -1)
+    for (int i = 0; i < static_cast<int>(uniformID::count); i++)
+    {
+        if (uniformLocations[i] == -1)
+            std::cerr << "invalid uniform: " << uniformNames[i] << " not active in " << sourceFile << std::endl;
+    }
 }
 
+void shader::setUniform1f(uniformID id, float desiredVal) const
+{
+    glUniform1f(uniformLocations[static_cast<int>(id)], desiredVal);
+}
+
+void shader::setUniform1i(uniformID id, int desiredVal) const
+{
+    glUniform1i(uniformLocations[static_cast<int>(id)], desiredVal);
+}
+
+void shader::setUniformV2(uniformID id, glm::vec2 desiredVec) const
+{
+    glUniform2fv(uniformLocations[static_cast<int>(id)], 1, glm::value_ptr(desiredVec));
+}
+
+void shader::setUniformV3(uniformID id, glm::vec3 desiredVec) const
+{
+    glUniform3fv(uniformLocations[static_cast<int>(id)], 1, glm::value_ptr(desiredVec));
+}
+
+void shader::setUniformV4(uniformID id, glm::vec4 desiredVec) const
+{
+    glUniform4fv(uniformLocations[static_cast<int>(id)], 1, glm::value_ptr(desiredVec));
+}
+
+void shader::setUniformMat3(uniformID id, glm::mat3 desiredMatrix) const
+{
+    glUniformMatrix3fv(uniformLocations[static_cast<int>(id)], 1, GL_FALSE, glm::value_ptr(desiredMatrix));
+}
 
 void shader::setUniform1f(const std::string& uniformName, float desiredVal) const
 {
-    int uniformLocation = glGetUniformLocation(VF_ProgID, uniformName.c_str());
+    int uniformLocation = glGetUniformLocation(namedProgram(), uniformName.c_str());
     if (uniformLocation != -1)
     {
         glUniform1f(uniformLocation, desiredVal);
@@ -281,7 +437,7 @@ void shader::setUniform1f(const std::string& uniformName, float desiredVal) cons
 
 void shader::setUniform1i(const std::string& uniformName, int desiredVal) const
 {
-    int uniformLocation = glGetUniformLocation(VF_ProgID, uniformName.c_str());
+    int uniformLocation = glGetUniformLocation(namedProgram(), uniformName.c_str());
     if (uniformLocation != -1)
     {
         glUniform1i(uniformLocation, desiredVal);
@@ -293,7 +449,7 @@ void shader::setUniform1i(const std::string& uniformName, int desiredVal) const
 
 void shader::setUniformV2(const std::string& uniformName, glm::vec2 desiredVec) const
 {
-    int uniformLocation = glGetUniformLocation(VF_ProgID, uniformName.c_str());
+    int uniformLocation = glGetUniformLocation(namedProgram(), uniformName.c_str());
     if (uniformLocation != -1)
     {
         glUniform2fv(uniformLocation, 1, glm::value_ptr(desiredVec));
@@ -304,7 +460,7 @@ void shader::setUniformV2(const std::string& uniformName, glm::vec2 desiredVec)
 
 void shader::setUniformV3(const std::string& uniformName, glm::vec3 desiredVec) const
 {
-    int uniformLocation = glGetUniformLocation(VF_ProgID, uniformName.c_str());
+    int uniformLocation = glGetUniformLocation(namedProgram(), uniformName.c_str());
     if (uniformLocation != -1)
     {
         glUniform3fv(uniformLocation, 1, glm::value_ptr(desiredVec));
@@ -315,7 +471,7 @@ void shader::setUniformV3(const std::string& uniformName, glm::vec3 desiredVec)
 
 void shader::setUniformV4(const std::string& uniformName, glm::vec4 desiredVec) const
 {
-    int uniformLocation = glGetUniformLocation(VF_ProgID, uniformName.c_str());
+    int uniformLocation = glGetUniformLocation(namedProgram(), uniformName.c_str());
     if (uniformLocation != -1)
     {
         glUniform4fv(uniformLocation, 1, glm::value_ptr(desiredVec));
@@ -327,7 +483,7 @@ void shader::setUniformV4(const std::string& uniformName, glm::vec4 desiredVec)
 void shader::setUniformMat3(const std::string& uniformName, glm::mat3 desiredMatrix) const
 {
     // get the location of uniform
-    int uniformLocation = glGetUniformLocation(VF_ProgID, uniformName.c_str());
+    int uniformLocation = glGetUniformLocation(namedProgram(), uniformName.c_str());
     // upload the matrix to the shader
     if (uniformLocation != -1)
         glUniformMatrix3fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(desiredMatrix));
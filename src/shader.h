@@ -1,19 +1,29 @@
 #pragma once
 
 #include "common.h"
+#include "juliaSettings.h"
+#include "juliaParams.h"
+
+#include <array>
+#include <utility>
 
 
 static const std::string baseShaderPath = "shaders/";
 
-struct juliaSettings
+// local_size_x / local_size_y of the compute render shaders
+static const int COMPUTE_TILE_SIZE = 8;
+
+// loose uniforms of the render programs, locations are looked up once after linking
+// everything shared between programs lives in the juliaParams uniform block instead
+enum class uniformID
 {
-	int aaSamples = 4;
-	int maxIterations = 80;
-	float epsilon = 1e-3f;
-	glm::vec4 juliaConstant = glm::vec4(-0.04f, 0.95f, 0.4f, -0.43f);
-	float fov = 90.0f;
+	sampleOffset,
+	useReprojection,
+	count
 };
 
+// NAME / value pairs written as #define lines right after #version, see shaderVariants
+typedef std::vector<std::pair<std::string, std::string>> shaderDefines;
 
 struct ShaderSources
 {
@@ -25,11 +35,18 @@ struct ShaderSources
 class shader
 {
 public:
-	shader(const std::string& vertFile, const std::string& fragFile)
-		: VF_ProgID(0), Comp_ProgID(0), vertSourceFile(vertFile), fragSourceFile(fragFile)
+	shader(const std::string& vertFile, const std::string& fragFile, const shaderDefines& defines = shaderDefines())
+		: VF_ProgID(0), Comp_ProgID(0), vertSourceFile(vertFile), fragSourceFile(fragFile), defineBlock(defineLines(defines))
 	{
+		uniformLocations.fill(-1);
 		loadVertFrag(vertFile, fragFile);
-		//loadCompute(compFile);
+	}
+	// compute-only program, the loose uniform table is looked up in it instead
+	explicit shader(const std::string& compFile, const shaderDefines& defines = shaderDefines())
+		: VF_ProgID(0), Comp_ProgID(0), computeSourceFile(compFile), defineBlock(defineLines(defines))
+	{
+		uniformLocations.fill(-1);
+		loadCompute(compFile);
 	}
 	~shader();
 
@@ -42,12 +59,28 @@ public:
 	void bindVF() const;
 	void unbindVF() const;
 
-	bool settingsChanged();
-	void updateSettings() const;
+	unsigned int getComp_ID() const;
+	void bindComp() const;
+	// enough COMPUTE_TILE_SIZE^2 groups to cover width x height, the program must be bound
+	void dispatchCompute(int width, int height) const;
+
+	// settingsField bits of everything that changed since the last call, 0 if nothing did
+	unsigned settingsChanged();
+	void updateSettings(juliaParams* pParams) const;
 
 	// uniforms
 	//void setUniformMat4(const std::string& uniformName, glm::mat4 desiredMatrix) const;
 
+	// cached location, no driver lookup on the hot path
+	void setUniform1f(uniformID id, float desiredVal) const;
+	void setUniform1i(uniformID id, int desiredVal) const;
+	void setUniformV2(uniformID id, glm::vec2 desiredVec) const;
+	void setUniformV3(uniformID id, glm::vec3 desiredVec) const;
+	void setUniformV4(uniformID id, glm::vec4 desiredVec) const;
+	void setUniformMat3(uniformID id, glm::mat3 desiredMatrix) const;
+
+	// looks the name up every call, for uniforms outside the cached table
+	// they go to the vert/frag program, or the compute program of a compute-only shader
 	void setUniform1f(const std::string& uniformName, float desiredVal) const;
 	void setUniform1i(const std::string& uniformName, int desiredVal) const;
 	void setUniformV2(const std::string& uniformName, glm::vec2 desiredVec) const;
@@ -63,11 +96,16 @@ private:
 	const std::string vertSourceFile;   // file path to vert shader
 	const std::string fragSourceFile;   // file path to frag shader
 	const std::string computeSourceFile;   // file path to frag shader
+	const std::string defineBlock;      // #define lines injected into every stage, empty for the generic program
 	ShaderSources shaderSourceCode;    // store shader source code
 	juliaSettings prevSet;
+	std::array<int, static_cast<size_t>(uniformID::count)> uniformLocations;
 
 	// private methods
+	static std::string defineLines(const shaderDefines& defines);
 	unsigned int createVFProgram();
 	unsigned int createCompProgram();
+	void cacheUniformLocations(unsigned int program, const std::string& sourceFile);
+	unsigned int namedProgram() const;
 };
 
@@ -0,0 +1,158 @@
+#include "shaderVariants.h"
+
+#include <algorithm>
+
+shaderDefines variantDefines(const juliaParamsStd140& block)
+{
+	return {
+		{ "VARIANT_MAX_STEPS", std::to_string(block.maxSteps) },
+		{ "VARIANT_AASAMPLES", std::to_string(block.aaSamples) },
+		{ "VARIANT_MAX_AASAMPLES", std::to_string(block.maxAASamples) },
+		{ "VARIANT_NORMAL_MODE", std::to_string(block.normalMode) },
+	};
+}
+
+static std::string variantKey(variantProgram program, const shaderDefines& defines)
+{
+	std::string key = program == variantProgram::fragment ? "fragment" : "compute";
+	for (const auto& define : defines)
+		key += " " + define.first + "=" + define.second;
+	return key;
+}
+
+shaderVariants::shaderVariants(GLFWwindow* shareWith, int capacity)
+	: context(nullptr), maxVariants(static_cast<size_t>(std::max(capacity, 1))), pendingProgram(variantProgram::fragment),
+	requested(0), started(0), finished(0), stopping(false)
+{
+	// same version and profile hints as the window, only hidden
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	context = glfwCreateWindow(1, 1, "shader variants", NULL, shareWith);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+	if (!context)
+	{
+		std::cerr << "failed to create the shader variant context, rendering with the generic programs only" << std::endl;
+		return;
+	}
+
+	worker = std::thread(&shaderVariants::workerLoop, this);
+}
+
+shaderVariants::~shaderVariants()
+{
+	stop();
+}
+
+void shaderVariants::stop()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	if (worker.joinable())
+		worker.join();
+
+	// the programs are shared, deleting them from the window's context is fine
+	built.clear();
+	variants.clear();
+	if (context)
+	{
+		glfwDestroyWindow(context);
+		context = nullptr;
+	}
+}
+
+bool shaderVariants::compiling()
+{
+	std::lock_guard<std::mutex> guard(lock);
+	return finished != requested;
+}
+
+void shaderVariants::collectBuilt()
+{
+	std::vector<variant> arrived;
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		arrived.swap(built);
+	}
+
+	for (variant& v : arrived)
+	{
+		variants.remove_if([&](const variant& existing) { return existing.key == v.key; });
+		variants.push_front(std::move(v));
+	}
+	while (variants.size() > maxVariants)
+		variants.pop_back();
+}
+
+shader* shaderVariants::find(variantProgram program, const juliaParamsStd140& block)
+{
+	if (!context)
+		return nullptr;
+
+	collectBuilt();
+
+	const shaderDefines defines = variantDefines(block);
+	const std::string key = variantKey(program, defines);
+	for (auto it = variants.begin(); it != variants.end(); ++it)
+	{
+		if (it->key != key)
+			continue;
+
+		variants.splice(variants.begin(), variants, it);
+		shader* s = variants.front().program.get();
+		const bool linked = program == variantProgram::fragment ? s->getVF_ID() != 0 : s->getComp_ID() != 0;
+		return linked ? s : nullptr;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if (pendingKey == key)
+			return nullptr;     // queued or compiling already
+		pendingKey = key;
+		pendingProgram = program;
+		pendingDefines = defines;
+		requested++;
+	}
+	wake.notify_all();
+	return nullptr;
+}
+
+void shaderVariants::workerLoop()
+{
+	glfwMakeContextCurrent(context);
+
+	std::unique_lock<std::mutex> guard(lock);
+	while (true)
+	{
+		wake.wait(guard, [this] { return stopping || started != requested; });
+		if (stopping)
+			break;
+
+		const std::string key = pendingKey;
+		const variantProgram program = pendingProgram;
+		const shaderDefines defines = pendingDefines;
+		const long long generation = requested;
+		started = generation;
+
+		guard.unlock();
+		variant v;
+		v.key = key;
+		if (program == variantProgram::fragment)
+			v.program.reset(new shader("shaders/render.vert", "shaders/juliaSet.frag", defines));
+		else
+			v.program.reset(new shader("shaders/juliaSet.comp", defines));
+		// the window's context may only use the program once the link has actually finished
+		glFinish();
+		guard.lock();
+
+		// kept even when a newer request arrived meanwhile, it is likely to be asked for again
+		built.push_back(std::move(v));
+		finished = generation;
+		// a failed build stays in the list and is not retried until it gets evicted
+		if (pendingKey == key)
+			pendingKey.clear();
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "shader.h"
+
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// linked variants kept around, flipping back to a recent iteration count or sample setting should not recompile
+static const int VARIANT_CACHE_SIZE = 8;
+
+// render programs a variant can be built from
+enum class variantProgram
+{
+	fragment,   // render.vert + juliaSet.frag
+	compute     // juliaSet.comp
+};
+
+// values of the block a variant is specialized on, injected as the VARIANT_* defines juliaCommon.glsl looks for
+// taken from the uploaded block rather than juliaSettings, accumulation overrides the sample counts there
+shaderDefines variantDefines(const juliaParamsStd140& block);
+
+// render programs with the iteration count, sample counts and normal mode compiled in as constants
+// variants are compiled and linked on a hidden context that shares objects with the window's, so a settings
+// change never stalls a frame, the caller keeps drawing with the generic program until the variant is ready
+// the most recently used variants stay linked, the oldest is deleted once there are more than capacity
+class shaderVariants
+{
+public:
+	explicit shaderVariants(GLFWwindow* shareWith, int capacity = VARIANT_CACHE_SIZE);
+	~shaderVariants();
+
+	shaderVariants(const shaderVariants&) = delete;
+	shaderVariants& operator=(const shaderVariants&) = delete;
+
+	// the variant of program for block, nullptr while it is still compiling or if it failed to build
+	// a miss queues the compile, only the newest request is built when several arrive during one compile
+	shader* find(variantProgram program, const juliaParamsStd140& block);
+
+	// stops the compile thread and deletes every variant, must run before the window's context goes away
+	void stop();
+
+	bool valid() const { return context != nullptr; };
+	// a requested variant has not come back from the compile thread yet
+	bool compiling();
+	int size() const { return static_cast<int>(variants.size()); };
+private:
+	struct variant
+	{
+		std::string key;
+		std::unique_ptr<shader> program;    // null program IDs inside when the build failed
+	};
+
+	void collectBuilt();
+	void workerLoop();
+
+	GLFWwindow* context;
+	std::thread worker;
+	std::list<variant> variants;    // most recently used first
+	size_t maxVariants;
+
+	std::mutex lock;
+	std::condition_variable wake;
+	std::string pendingKey;
+	variantProgram pendingProgram;
+	shaderDefines pendingDefines;
+	long long requested;    // generation of the latest request
+	long long started;      // generation the worker picked up last
+	long long finished;     // generation of the last variant the worker built
+	std::vector<variant> built;     // linked on the worker, waiting to be moved into variants
+	bool stopping;
+};
@@ -0,0 +1,46 @@
+#include "temporalCache.h"
+
+// texture unit reproject.comp reads the previous frame's distances from
+static const unsigned int PREV_DEPTH_UNIT = 3;
+static const unsigned int REPROJECT_IMAGE_UNIT = 2;
+
+temporalCache::temporalCache()
+	: reprojectShader("shaders/reproject.comp"), reprojTarget({ GL_R32UI }), prevRotation(1.0f), havePrev(false)
+{
+}
+
+bool temporalCache::reproject(unsigned int prevDepth, int width, int height, const glm::mat3& rotation)
+{
+	if (!valid() || !havePrev)
+		return false;
+
+	reprojTarget.resize(width, height);
+
+	// nothing landed yet, the fractal pass reads 0xFFFFFFFF as a full march
+	const GLuint cleared[4] = { 0xFFFFFFFFu, 0u, 0u, 0u };
+	reprojTarget.bind();
+	glClearBufferuiv(GL_COLOR, 0, cleared);
+
+	reprojectShader.bindComp();
+	reprojectShader.setUniformMat3("reprojRotation", glm::transpose(rotation) * prevRotation);
+	glActiveTexture(GL_TEXTURE0 + PREV_DEPTH_UNIT);
+	glBindTexture(GL_TEXTURE_2D, prevDepth);
+	glActiveTexture(GL_TEXTURE0);
+	glBindImageTexture(REPROJECT_IMAGE_UNIT, reprojTarget.texture(0), 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+	reprojectShader.dispatchCompute(width, height);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	return true;
+}
+
+void temporalCache::bind() const
+{
+	glActiveTexture(GL_TEXTURE0 + REPROJECT_DEPTH_UNIT);
+	glBindTexture(GL_TEXTURE_2D, reprojTarget.texture(0));
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void temporalCache::frameRendered(const glm::mat3& rotation)
+{
+	prevRotation = rotation;
+	havePrev = true;
+}
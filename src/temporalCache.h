@@ -0,0 +1,39 @@
+#pragma once
+
+#include "shader.h"
+#include "renderTarget.h"
+
+// texture unit the fractal programs read reprojected distances from (reprojDepth in juliaCommon.glsl)
+static const unsigned int REPROJECT_DEPTH_UNIT = 2;
+// image unit the compute render path writes its hit distances to (depthImage in juliaSet.comp)
+static const unsigned int HIT_DEPTH_IMAGE_UNIT = 3;
+
+// carries last frame's hit distances into the current rotation so primary rays can start next to the surface
+// only rotation may change in between, anything else that moves the surface invalidates the cache
+class temporalCache
+{
+public:
+	temporalCache();
+
+	temporalCache(const temporalCache&) = delete;
+	temporalCache& operator=(const temporalCache&) = delete;
+
+	// scatters the hit distances in prevDepth (written with prevRotation) into the view of rotation
+	// returns false when there is nothing valid to reproject, the fractal pass then marches in full
+	bool reproject(unsigned int prevDepth, int width, int height, const glm::mat3& rotation);
+
+	// makes the reprojected distances visible to the fractal programs
+	void bind() const;
+
+	// the fractal pass wrote new hit distances for rotation
+	void frameRendered(const glm::mat3& rotation);
+	// the stored distances no longer describe the surface (settings or size changed)
+	void invalidate() { havePrev = false; };
+
+	bool valid() const { return reprojectShader.getComp_ID() != 0; };
+private:
+	shader reprojectShader;
+	renderTarget reprojTarget;
+	glm::mat3 prevRotation;
+	bool havePrev;
+};
@@ -0,0 +1,108 @@
+#include "threadPool.h"
+
+#include <algorithm>
+
+threadPool::threadPool(unsigned threadCount)
+    : queues(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency())),
+      currentJob(nullptr), remaining(0), generation(0), stopping(false)
+{
+    workers.reserve(queues.size());
+    for (unsigned i = 0; i < queues.size(); i++)
+        workers.emplace_back(&threadPool::workerLoop, this, i);
+}
+
+threadPool::~threadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void threadPool::parallelFor(int count, const std::function<void(int)>& job)
+{
+    if (count <= 0)
+        return;
+
+    currentJob = &job;
+    remaining.store(count);
+
+    // deal out contiguous runs, queue locks publish currentJob to the workers
+    const unsigned n = size();
+    for (unsigned w = 0; w < n; w++)
+    {
+        int begin = static_cast<int>(static_cast<long long>(count) * w / n);
+        int end = static_cast<int>(static_cast<long long>(count) * (w + 1) / n);
+
+        std::lock_guard<std::mutex> guard(queues[w].lock);
+        for (int i = begin; i < end; i++)
+            queues[w].items.push_back(i);
+    }
+
+    std::unique_lock<std::mutex> guard(stateLock);
+    generation++;
+    wake.notify_all();
+    done.wait(guard, [this] { return remaining.load() == 0; });
+    currentJob = nullptr;
+}
+
+bool threadPool::popOrSteal(unsigned index, int& item)
+{
+    {
+        workQueue& own = queues[index];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.items.empty())
+        {
+            item = own.items.back();
+            own.items.pop_back();
+            return true;
+        }
+    }
+
+    const unsigned n = size();
+    for (unsigned offset = 1; offset < n; offset++)
+    {
+        workQueue& victim = queues[(index + offset) % n];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.items.empty())
+        {
+            item = victim.items.front();
+            victim.items.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void threadPool::workerLoop(unsigned index)
+{
+    unsigned seenGeneration = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> guard(stateLock);
+            wake.wait(guard, [&] { return stopping || generation != seenGeneration; });
+            if (stopping)
+                return;
+            seenGeneration = generation;
+        }
+
+        int item;
+        while (popOrSteal(index, item))
+        {
+            (*currentJob)(item);
+
+            if (remaining.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> guard(stateLock);
+                done.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of workers, each with its own deque of work items
+// a worker pops from the back of its own deque and steals from the front of the others when it runs dry
+class threadPool
+{
+public:
+	explicit threadPool(unsigned threadCount = 0); // 0 = one worker per hardware thread
+	~threadPool();
+
+	threadPool(const threadPool&) = delete;
+	threadPool& operator=(const threadPool&) = delete;
+
+	unsigned size() const { return static_cast<unsigned>(workers.size()); };
+
+	// runs job(i) for every i in [0, count) and blocks until all are done
+	// items are handed out in contiguous runs so neighbouring tiles stay on one core until stolen
+	void parallelFor(int count, const std::function<void(int)>& job);
+
+private:
+	struct workQueue
+	{
+		std::mutex lock;
+		std::deque<int> items;
+	};
+
+	void workerLoop(unsigned index);
+	bool popOrSteal(unsigned index, int& item);
+
+	std::vector<std::thread> workers;
+	std::vector<workQueue> queues;
+
+	std::mutex stateLock;
+	std::condition_variable wake;
+	std::condition_variable done;
+	const std::function<void(int)>* currentJob;
+	std::atomic<int> remaining;
+	unsigned generation;
+	bool stopping;
+};